@@ -261,6 +261,7 @@ document.addEventListener('DOMContentLoaded', () => {
                     <p><span class="text-gray-400">Object 2:</span> ${event.object2_name}</p>
                     <p><span class="text-gray-400">Min. Distance:</span> <span class="text-red-400 font-bold">${event.min_distance_km.toFixed(2)} km</span></p>
                     <p><span class="text-gray-400">Time from now:</span> ${event.time_from_now_hr.toFixed(1)} hours</p>
+                    ${event.tca_utc ? `<p><span class="text-gray-400">TCA (UTC):</span> ${event.tca_utc}</p>` : ''}
                 </div></div>`;
         });
         cardsHTML += `</div>`;
@@ -306,6 +307,24 @@ document.addEventListener('DOMContentLoaded', () => {
     }
 
     // --- API FETCH LOGIC ---
+    // Polls an async job until it finishes and returns its result.
+    async function waitForJob(jobId, signal) {
+        while (true) {
+            await new Promise(resolve => setTimeout(resolve, 2000));
+            const response = await fetch(`${SERVER_URL}/jobs/${jobId}`, {
+                method: 'POST',
+                headers: { 'Content-Type': 'application/json' },
+                body: JSON.stringify({ email: user.email, token: token }),
+                signal
+            });
+            if (!response.ok) throw new Error(`HTTP error! Status: ${response.status}`);
+            const job = await response.json();
+            if (job.error) throw new Error(job.error);
+            if (job.status === 'done') return job.result;
+            dataOutput.innerHTML = `<div class="text-yellow-400 text-center p-4">Screening the catalog... ${job.progress}%</div>`;
+        }
+    }
+
     async function fetchAPI(endpoint, body, title) {
         if (currentApiController) currentApiController.abort();
         currentApiController = new AbortController();
@@ -330,7 +349,8 @@ document.addEventListener('DOMContentLoaded', () => {
             }
              if (!response.ok) throw new Error(`HTTP error! Status: ${response.status}`);
             
-            const data = await response.json();
+            let data = await response.json();
+            if (data.job_id) data = await waitForJob(data.job_id, currentApiController.signal);
 
             if (isPlanner) displayPlannerResults(data);
             else if (endpoint === '/list' || endpoint === '/filter') displayListOrFilter(data, title);
@@ -430,7 +450,7 @@ document.addEventListener('DOMContentLoaded', () => {
         const duration = parseInt(document.getElementById('duration').value);
         const step = parseInt(document.getElementById('step').value);
         const threshold = parseFloat(document.getElementById('threshold').value);
-        fetchAPI('/predict', { duration, step, threshold }, "Collision Prediction");
+        fetchAPI('/predict', { duration, step, threshold, refine: true, async: true }, "Collision Prediction");
     });
     document.getElementById('btnPlan').addEventListener('click', () => {
         const target_alt = parseFloat(document.getElementById('target_alt_plan').value);
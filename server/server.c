@@ -6,6 +6,7 @@
  *
  * COMPILE:
  * gcc -o space_debris_server server.c cJSON.c -lcurl -lm -lpthread
+ * (add -O2 -march=native to enable the AVX2/AVX-512 batch propagator)
  *
  * RUN:
  * ./space_debris_server
@@ -16,28 +17,144 @@
 #include <ctype.h>
 #include <time.h>
 #include <math.h>
+#include <float.h>
+#include <limits.h>
+#include <stdint.h>
 #include <curl/curl.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
 #include "cJSON.h"
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
 // --- Constants and Structs ---
-#define MAX_SATS 10000
 #define MAX_USERS 100
 #define BUFFER_SIZE 8192
 #define LINE_LEN 256
 #define NAME_LEN 128
 #define USERS_DB_FILE "users.json"
+#ifndef SCREEN_THREADS
+#define SCREEN_THREADS 0 /* screening worker threads; 0 = one per online CPU */
+#endif
+#ifndef REFINE_STEP_SEC
+#define REFINE_STEP_SEC 60 /* widest sample spacing used to seed TCA refinement */
+#endif
+#ifndef SCREEN_SIEVE
+#define SCREEN_SIEVE 1 /* 0 sweeps every object the sieve would drop too; for checking the sieve against a full sweep */
+#endif
+#ifndef SCREEN_COARSE_FLOAT
+#define SCREEN_COARSE_FLOAT 1 /* scalar sweep pair tests on float32 grid copies, confirmed in double; 0 = double only */
+#endif
+#ifndef SCREEN_TILE_STEPS
+#define SCREEN_TILE_STEPS 16 /* most time steps in one piece of a sweep; bounds how long other jobs wait for a worker */
+#endif
+#ifndef SCREEN_ADAPTIVE_ROWS
+#define SCREEN_ADAPTIVE_ROWS 8 /* primary mode: up to this many primaries, each object is sampled only when it could reach one */
+#endif
+#ifndef GROUP_NAME_DELIMITERS
+#define GROUP_NAME_DELIMITERS " \t" /* a name's constellation is its text up to the first of these; add "-" to group STARLINK-1234 */
+#endif
+#ifndef GROUP_NAME_MIN_LEN
+#define GROUP_NAME_MIN_LEN 3 /* shorter name prefixes form no constellation */
+#endif
+#ifndef CACHE_HORIZON_DAYS
+#define CACHE_HORIZON_DAYS 7 /* window of the background conjunction cache */
+#endif
+#ifndef CACHE_THRESHOLD_KM
+#define CACHE_THRESHOLD_KM 20.0 /* largest threshold the cache can answer */
+#endif
+#ifndef CACHE_ROLL_SEC
+#define CACHE_ROLL_SEC 3600 /* how often the cache drops its past and screens the newly exposed tail */
+#endif
+#ifndef CATALOG_SNAPSHOT
+#define CATALOG_SNAPSHOT "catalog.snap" /* parsed catalog, loaded at startup when newer than the text files */
+#endif
+#ifndef CATALOG_REFRESH_SEC
+#define CATALOG_REFRESH_SEC 14400 /* how often the TLE catalog is downloaded again and applied */
+#endif
+#ifndef CATALOG_MIN_CAPACITY
+#define CATALOG_MIN_CAPACITY 1024 /* first allocation of a catalog array; it doubles as the catalog grows */
+#endif
+#ifndef JOB_RUNNERS
+#define JOB_RUNNERS 2 /* screening requests computed at once, sync or async; the rest wait in the queue */
+#endif
+#ifndef MAX_JOBS
+#define MAX_JOBS 64 /* queued, running and unexpired finished jobs */
+#endif
+#ifndef STREAM_QUEUE_LINES
+#define STREAM_QUEUE_LINES 256 /* streamed events formatted but not yet sent; screening waits while this many are pending */
+#endif
+#ifndef CLIENT_SEND_TIMEOUT_SEC
+#define CLIENT_SEND_TIMEOUT_SEC 10 /* a send blocked this long gives up on the client */
+#endif
+#ifndef JOB_TTL_SEC
+#define JOB_TTL_SEC 3600 /* how long a finished job's result is kept */
+#endif
 
 /* Physical constants */
 const double EARTH_MU = 398600.4418; /* km^3 / s^2 */
 const double EARTH_RADIUS = 6378.137; /* km (equatorial) */
+const double EARTH_J2 = 1.08262668e-3; /* second zonal harmonic */
+
+typedef struct Ephemeris Ephemeris;
+
+/* Orbit models a request can pick; MODEL_SGP4 is the default. */
+typedef enum {
+    MODEL_SGP4,   /* SGP4 for near-Earth orbits, two-body for deep space */
+    MODEL_J2,     /* two-body plus the J2 secular drift of node, perigee and mean anomaly */
+    MODEL_KEPLER, /* plain two-body */
+} PropagationModel;
+
+/* Pairs a request leaves out of screening; EXCLUDE_CONSTELLATION is the default. */
+typedef enum {
+    EXCLUDE_CONSTELLATION, /* both objects share a constellation (name prefix) */
+    EXCLUDE_LAUNCH,        /* both objects came from the same launch */
+    EXCLUDE_EITHER,        /* either of the above */
+    EXCLUDE_NONE,
+} ExclusionPolicy;
+
+/* Per-TLE constants of the two-body and J2 models, derived once when the TLE is parsed. */
+typedef struct {
+    double n;          /* mean motion, rad/s */
+    double b;          /* semi-minor axis, km */
+    double p[3], q[3]; /* perifocal frame: toward perigee, and 90 degrees ahead in the orbit plane */
+    double w[3];       /* orbit normal */
+    double a_j2, b_j2; /* J2: semi-axes from the Brouwer mean motion, km */
+    double n_j2;       /* J2: mean anomaly rate, rad/s */
+    double raan_dot;   /* J2: nodal regression, rad/s */
+    double argp_dot;   /* J2: apsidal rotation, rad/s */
+} PreparedOrbit;
+
+/*
+ * Near-Earth SGP4 state of one TLE, set up once at parse time (Vallado's
+ * sgp4init). Lengths are in Earth radii and times in minutes, as in SGP4.
+ */
+typedef struct {
+    int active;      /* 0: deep-space orbit, propagated two-body */
+    int isimp;       /* perigee below 220 km: drop the higher drag terms */
+    double bstar;
+    double ecco, inclo, nodeo, argpo, mo, no; /* no: un-Kozai'd mean motion, rad/min */
+    double aok;      /* (xke / no)^(2/3) */
+    double sinio, cosio;
+    double con41, x1mth2, x7thm1;
+    double cc1, cc4, cc5, d2, d3, d4;
+    double delmo, eta, sinmao;
+    double mdot, argpdot, nodedot, nodecf;
+    double omgcof, xmcof, xlcof, aycof;
+    double t2cof, t3cof, t4cof, t5cof;
+} Sgp4;
 
 typedef struct {
     char name[NAME_LEN];
@@ -54,6 +171,11 @@ typedef struct {
     double semi_major_axis;
     double epoch_time;
     int valid;
+    int constellation;    /* interned name prefix: index of the first satellite with it; -1 = none */
+    int launch;           /* interned launch of the international designator, likewise; -1 = none */
+    PreparedOrbit orbit;
+    Sgp4 sgp4;
+    Ephemeris *ephemeris; /* Chebyshev fit of the orbit, made on first use; NULL = not tried yet */
 } Satellite;
 
 // --- NEW: SATCAT Data Structure ---
@@ -63,7 +185,7 @@ typedef struct {
     char country[NAME_LEN];
     char launch_date[12];
     char purpose[NAME_LEN];
-    char status[16];
+    char status[24];
 } SatCatData;
 
 
@@ -76,189 +198,3397 @@ typedef struct {
     long plan_expiry_date; // timestamp
 } User;
 
-// --- Global Data ---
-static Satellite SATS_DB[MAX_SATS];
-static int SATS_COUNT = 0;
-// --- NEW: Global Database for SATCAT data ---
-static SatCatData SATCAT_DB[MAX_SATS];
-static int SATCAT_COUNT = 0;
+/*
+ * The satellite catalog with everything derived from it (constellation and
+ * launch groups) and the SATCAT records, never modified once published but
+ * for each satellite's ephemeris, fitted on first use. See "Published
+ * Catalog" for how it is read and replaced.
+ */
+typedef struct {
+    int refs;                 /* atomic; held by its slot while it is current */
+    unsigned long generation; /* one more than the catalog it replaced */
+    Satellite *sats;
+    int count;
+    SatCatData *satcat;
+    int satcat_count;
+} Catalog;
+
+// --- Global Data ---
+static Catalog *CATALOG_SLOTS[2];           /* the current catalog and the one before it */
+static unsigned long CATALOG_TICKETS;       /* bit 0: the current slot; the rest count catalog_acquire calls on it */
+static unsigned long CATALOG_CLAIMED[2];    /* per slot, the calls that have taken their reference */
+
+static User USERS_DB[MAX_USERS];
+static int USERS_COUNT = 0;
+pthread_mutex_t db_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// --- Worker Pool ---
+/*
+ * Fixed pool of compute threads shared by every screening request and catalog
+ * load. A job's task runs a piece at a time: each call does one piece of work
+ * (a tile, a chunk of records) and returns 0 once none is left. Jobs run side
+ * by side: an idle worker takes its next piece from the job with the fewest
+ * workers on it, then the one that has had the least worker time, so a
+ * request submitted during a cache build gets an even share of the pool from
+ * the build's next piece boundary instead of waiting out the whole build.
+ *
+ * A worker runs one piece at a time, so per-worker buffers indexed by its
+ * number stay private to it whichever jobs are running.
+ */
+typedef int (*PoolTask)(void *ctx, int worker);
+
+typedef struct PoolJob {
+    PoolTask task;
+    void *ctx;
+    int busy;             /* workers running a piece of it */
+    int drained;          /* a piece found no work left, so no new piece starts */
+    int finished;         /* drained and no piece running */
+    double spent;         /* worker seconds, counted from the least any job had when it was queued */
+    struct PoolJob *next;
+} PoolJob;
+
+typedef struct {
+    pthread_t *threads;
+    int size;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+    PoolJob *jobs;        /* unfinished jobs, oldest first */
+} WorkerPool;
+
+typedef struct {
+    WorkerPool *pool;
+    int index;
+} PoolThreadArg;
+
+static WorkerPool SCREEN_POOL = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER,
+};
+
+/*
+ * The undrained job with the fewest workers on it, and of those the one that
+ * has had the least worker time. Caller holds pool->lock.
+ */
+static PoolJob *worker_pool_next(WorkerPool *pool) {
+    PoolJob *next = NULL;
+    for (PoolJob *job = pool->jobs; job; job = job->next) {
+        if (job->drained) continue;
+        if (!next || job->busy < next->busy || (job->busy == next->busy && job->spent < next->spent)) next = job;
+    }
+    return next;
+}
+
+static double pool_clock(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static void *pool_thread(void *arg) {
+    WorkerPool *pool = ((PoolThreadArg *)arg)->pool;
+    int index = ((PoolThreadArg *)arg)->index;
+    free(arg);
+    pthread_mutex_lock(&pool->lock);
+    while (1) {
+        PoolJob *job = worker_pool_next(pool);
+        if (!job) { pthread_cond_wait(&pool->wake, &pool->lock); continue; }
+        job->busy++;
+        pthread_mutex_unlock(&pool->lock);
+        double started = pool_clock();
+        int more = job->task(job->ctx, index);
+        double spent = pool_clock() - started;
+        pthread_mutex_lock(&pool->lock);
+        job->spent += spent;
+        job->busy--;
+        if (!more) job->drained = 1;
+        if (job->drained && job->busy == 0 && !job->finished) {
+            PoolJob **link = &pool->jobs;
+            while (*link != job) link = &(*link)->next;
+            *link = job->next;
+            job->finished = 1;
+            pthread_cond_broadcast(&pool->done);
+        }
+    }
+    return NULL;
+}
+
+static int worker_pool_start(WorkerPool *pool, int size) {
+    if (size <= 0) size = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (size <= 0) size = 1;
+    pool->threads = malloc(sizeof(pthread_t) * size);
+    if (!pool->threads) return 0;
+    for (int k = 0; k < size; ++k) {
+        PoolThreadArg *arg = malloc(sizeof(PoolThreadArg));
+        if (!arg) break;
+        arg->pool = pool;
+        arg->index = k;
+        if (pthread_create(&pool->threads[k], NULL, pool_thread, arg) != 0) { free(arg); break; }
+        pthread_detach(pool->threads[k]);
+        pool->size = k + 1;
+    }
+    return pool->size > 0;
+}
+
+/* Number of workers a task will see; per-worker buffers are sized from this. */
+static int worker_pool_width(const WorkerPool *pool) {
+    return pool->size > 0 ? pool->size : 1;
+}
+
+/* Runs task(ctx, worker) on the pool until it reports no work left, and waits for every piece. */
+static void worker_pool_run(WorkerPool *pool, PoolTask task, void *ctx) {
+    if (pool->size == 0) {
+        while (task(ctx, 0)) {}
+        return;
+    }
+    PoolJob job = { .task = task, .ctx = ctx };
+    pthread_mutex_lock(&pool->lock);
+    PoolJob **tail = &pool->jobs;
+    if (*tail) job.spent = (*tail)->spent;
+    for (; *tail; tail = &(*tail)->next) {
+        if ((*tail)->spent < job.spent) job.spent = (*tail)->spent;
+    }
+    *tail = &job;
+    pthread_cond_broadcast(&pool->wake);
+    while (!job.finished) pthread_cond_wait(&pool->done, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/*
+ * Work-stealing tile scheduler: each worker starts with a contiguous range of
+ * tiles and takes from its front; an idle worker steals the back half of the
+ * first non-empty range it finds.
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    long next, end;
+} TileRange;
+
+typedef struct {
+    TileRange *ranges;
+    int workers;
+} TileScheduler;
+
+static int tile_scheduler_init(TileScheduler *s, int workers, long tiles) {
+    s->ranges = malloc(sizeof(TileRange) * workers);
+    if (!s->ranges) return 0;
+    s->workers = workers;
+    for (int w = 0; w < workers; ++w) {
+        pthread_mutex_init(&s->ranges[w].lock, NULL);
+        s->ranges[w].next = tiles * w / workers;
+        s->ranges[w].end = tiles * (w + 1) / workers;
+    }
+    return 1;
+}
+
+static void tile_scheduler_free(TileScheduler *s) {
+    for (int w = 0; w < s->workers; ++w) pthread_mutex_destroy(&s->ranges[w].lock);
+    free(s->ranges);
+}
+
+/* Returns the next tile for `worker`, or -1 once every range is drained. */
+static long tile_scheduler_next(TileScheduler *s, int worker) {
+    TileRange *own = &s->ranges[worker];
+    pthread_mutex_lock(&own->lock);
+    if (own->next < own->end) {
+        long tile = own->next++;
+        pthread_mutex_unlock(&own->lock);
+        return tile;
+    }
+    pthread_mutex_unlock(&own->lock);
+    for (int k = 1; k < s->workers; ++k) {
+        TileRange *victim = &s->ranges[(worker + k) % s->workers];
+        pthread_mutex_lock(&victim->lock);
+        long left = victim->end - victim->next;
+        if (left <= 0) { pthread_mutex_unlock(&victim->lock); continue; }
+        long from = victim->end - (left + 1) / 2, to = victim->end;
+        victim->end = from;
+        pthread_mutex_unlock(&victim->lock);
+        pthread_mutex_lock(&own->lock);
+        own->next = from + 1;
+        own->end = to;
+        pthread_mutex_unlock(&own->lock);
+        return from;
+    }
+    return -1;
+}
+
+// --- Core Satellite Logic ---
+static double deg2rad(double deg) { return deg * M_PI / 180.0; }
+/*
+ * Fixed-width TLE fields, parsed in place: leading blanks, an optional sign,
+ * digits and an optional point, up to the first other character or `len`.
+ * Fields are at most 16 characters, so the digits fit a double exactly and
+ * one division rounds the value the way atof does.
+ */
+static const double POW10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8,
+                                1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16 };
+
+static double get_tle_val(const char *tle_line, int start, int len) {
+    const char *s = tle_line + start, *end = s + len;
+    while (s < end && *s == ' ') s++;
+    int negative = s < end && *s == '-';
+    if (s < end && (*s == '-' || *s == '+')) s++;
+    long long digits = 0;
+    int scale = 0, point = 0;
+    for (; s < end; ++s) {
+        if (*s >= '0' && *s <= '9') {
+            digits = digits * 10 + (*s - '0');
+            scale += point;
+        } else if (*s == '.' && !point) {
+            point = 1;
+        } else {
+            break;
+        }
+    }
+    double value = (double)digits / POW10[scale];
+    return negative ? -value : value;
+}
+static int get_tle_int(const char* tle_line, int start, int len) {
+    return (int)get_tle_val(tle_line, start, len);
+}
+/* A field with an implied leading decimal point, e.g. the eccentricity "0001234" = 0.0001234. */
+static double get_tle_fraction(const char *tle_line, int start, int len) {
+    const char *s = tle_line + start;
+    long long digits = 0;
+    int scale = 0;
+    while (scale < len && s[scale] >= '0' && s[scale] <= '9') digits = digits * 10 + (s[scale++] - '0');
+    return (double)digits / POW10[scale];
+}
+
+// --- SGP4 (near-Earth) ---
+/*
+ * Native SGP4 after Vallado et al., "Revisiting Spacetrack Report #3" (2006),
+ * with the WGS-72 constants the TLEs are fitted with. Only the near-Earth
+ * branch is implemented: deep-space orbits (period of 225 min or more) need
+ * the lunar-solar SDP4 terms and stay on the two-body model.
+ */
+#define SGP4_RE 6378.135                /* km */
+#define SGP4_XKE 0.0743669161331734132  /* sqrt(mu) in Earth radii^1.5 / min */
+#define SGP4_J2 0.001082616
+#define SGP4_J3 -0.00000253881
+#define SGP4_J4 -0.00000165597
+#define SGP4_DEEP_SPACE_MIN 225.0       /* period at which SDP4 takes over, min */
+
+/* BSTAR from TLE line 1, columns 54-61, e.g. " 28098-4" = 0.28098e-4. */
+static double parse_bstar(const char *tle1) {
+    double value = get_tle_fraction(tle1, 54, 5) * pow(10.0, get_tle_int(tle1, 59, 2));
+    return tle1[53] == '-' ? -value : value;
+}
+
+/* Sets up g from the parsed mean elements; g->active stays 0 for deep-space orbits. */
+static void sgp4_init(Sgp4 *g, const Satellite *sat) {
+    const double x2o3 = 2.0 / 3.0, j3oj2 = SGP4_J3 / SGP4_J2;
+    memset(g, 0, sizeof(*g));
+    g->bstar = parse_bstar(sat->tle1);
+    g->ecco = sat->eccentricity;
+    g->inclo = sat->inclination;
+    g->nodeo = sat->raan;
+    g->argpo = sat->arg_perigee;
+    g->mo = sat->mean_anomaly;
+    double no_kozai = sat->mean_motion * 2.0 * M_PI / 1440.0;
+
+    /* initl: recover the original mean motion from the Kozai one. */
+    double eccsq = g->ecco * g->ecco, omeosq = 1.0 - eccsq, rteosq = sqrt(omeosq);
+    double cosio = cos(g->inclo), cosio2 = cosio * cosio;
+    double ak = pow(SGP4_XKE / no_kozai, x2o3);
+    double d1 = 0.75 * SGP4_J2 * (3.0 * cosio2 - 1.0) / (rteosq * omeosq);
+    double del = d1 / (ak * ak);
+    double adel = ak * (1.0 - del * del - del * (1.0 / 3.0 + 134.0 * del * del / 81.0));
+    del = d1 / (adel * adel);
+    g->no = no_kozai / (1.0 + del);
+    if (2.0 * M_PI / g->no >= SGP4_DEEP_SPACE_MIN) return;
+
+    double ao = pow(SGP4_XKE / g->no, x2o3);
+    double sinio = sin(g->inclo);
+    double po = ao * omeosq, posq = po * po;
+    double rp = ao * (1.0 - g->ecco);
+    double con42 = 1.0 - 5.0 * cosio2;
+    g->aok = ao;
+    g->sinio = sinio;
+    g->cosio = cosio;
+    g->con41 = -con42 - cosio2 - cosio2;
+    g->x1mth2 = 1.0 - cosio2;
+    g->x7thm1 = 7.0 * cosio2 - 1.0;
+    g->isimp = rp < 220.0 / SGP4_RE + 1.0;
+
+    /* Atmospheric density parameters move down for low perigees. */
+    double sfour = 78.0 / SGP4_RE + 1.0;
+    double qzms24 = pow((120.0 - 78.0) / SGP4_RE, 4.0);
+    double perige = (rp - 1.0) * SGP4_RE;
+    if (perige < 156.0) {
+        sfour = perige < 98.0 ? 20.0 : perige - 78.0;
+        qzms24 = pow((120.0 - sfour) / SGP4_RE, 4.0);
+        sfour = sfour / SGP4_RE + 1.0;
+    }
+    double pinvsq = 1.0 / posq;
+    double tsi = 1.0 / (ao - sfour);
+    g->eta = ao * g->ecco * tsi;
+    double etasq = g->eta * g->eta, eeta = g->ecco * g->eta;
+    double psisq = fabs(1.0 - etasq);
+    double coef = qzms24 * pow(tsi, 4.0);
+    double coef1 = coef / pow(psisq, 3.5);
+    double cc2 = coef1 * g->no * (ao * (1.0 + 1.5 * etasq + eeta * (4.0 + etasq))
+               + 0.375 * SGP4_J2 * tsi / psisq * g->con41 * (8.0 + 3.0 * etasq * (8.0 + etasq)));
+    g->cc1 = g->bstar * cc2;
+    double cc3 = g->ecco > 1.0e-4 ? -2.0 * coef * tsi * j3oj2 * g->no * sinio / g->ecco : 0.0;
+    g->cc4 = 2.0 * g->no * coef1 * ao * omeosq
+           * (g->eta * (2.0 + 0.5 * etasq) + g->ecco * (0.5 + 2.0 * etasq)
+              - SGP4_J2 * tsi / (ao * psisq)
+                * (-3.0 * g->con41 * (1.0 - 2.0 * eeta + etasq * (1.5 - 0.5 * eeta))
+                   + 0.75 * g->x1mth2 * (2.0 * etasq - eeta * (1.0 + etasq)) * cos(2.0 * g->argpo)));
+    g->cc5 = 2.0 * coef1 * ao * omeosq * (1.0 + 2.75 * (etasq + eeta) + eeta * etasq);
+
+    double cosio4 = cosio2 * cosio2;
+    double temp1 = 1.5 * SGP4_J2 * pinvsq * g->no;
+    double temp2 = 0.5 * temp1 * SGP4_J2 * pinvsq;
+    double temp3 = -0.46875 * SGP4_J4 * pinvsq * pinvsq * g->no;
+    g->mdot = g->no + 0.5 * temp1 * rteosq * g->con41 + 0.0625 * temp2 * rteosq * (13.0 - 78.0 * cosio2 + 137.0 * cosio4);
+    g->argpdot = -0.5 * temp1 * con42 + 0.0625 * temp2 * (7.0 - 114.0 * cosio2 + 395.0 * cosio4)
+               + temp3 * (3.0 - 36.0 * cosio2 + 49.0 * cosio4);
+    double xhdot1 = -temp1 * cosio;
+    g->nodedot = xhdot1 + (0.5 * temp2 * (4.0 - 19.0 * cosio2) + 2.0 * temp3 * (3.0 - 7.0 * cosio2)) * cosio;
+    g->omgcof = g->bstar * cc3 * cos(g->argpo);
+    g->xmcof = g->ecco > 1.0e-4 ? -x2o3 * coef * g->bstar / eeta : 0.0;
+    g->nodecf = 3.5 * omeosq * xhdot1 * g->cc1;
+    g->t2cof = 1.5 * g->cc1;
+    double xlcof_den = fabs(cosio + 1.0) > 1.5e-12 ? 1.0 + cosio : 1.5e-12;
+    g->xlcof = -0.25 * j3oj2 * sinio * (3.0 + 5.0 * cosio) / xlcof_den;
+    g->aycof = -0.5 * j3oj2 * sinio;
+    g->delmo = pow(1.0 + g->eta * cos(g->mo), 3.0);
+    g->sinmao = sin(g->mo);
+    if (!g->isimp) {
+        double cc1sq = g->cc1 * g->cc1;
+        g->d2 = 4.0 * ao * tsi * cc1sq;
+        double temp = g->d2 * tsi * g->cc1 / 3.0;
+        g->d3 = (17.0 * ao + sfour) * temp;
+        g->d4 = 0.5 * temp * ao * tsi * (221.0 * ao + 31.0 * sfour) * g->cc1;
+        g->t3cof = g->d2 + 2.0 * cc1sq;
+        g->t4cof = 0.25 * (3.0 * g->d3 + g->cc1 * (12.0 * g->d2 + 10.0 * cc1sq));
+        g->t5cof = 0.2 * (3.0 * g->d4 + 12.0 * g->cc1 * g->d3 + 6.0 * g->d2 * g->d2 + 15.0 * cc1sq * (2.0 * g->d2 + cc1sq));
+    } else {
+        /* The simplified model: zero terms keep sgp4_state and the batch kernel branch-free. */
+        g->omgcof = g->xmcof = g->cc5 = 0.0;
+    }
+    g->active = 1;
+}
+
+/* Angle reduced to [0, 2 pi) without the cost of fmod. */
+static inline double sgp4_wrap(double a) {
+    return a - 2.0 * M_PI * floor(a * (1.0 / (2.0 * M_PI)));
+}
+
+/*
+ * TEME position (km) and velocity (km/s) `tsince` minutes after the TLE
+ * epoch. Returns 0 when the orbit has decayed or the elements went invalid.
+ */
+static int sgp4_state(const Sgp4 *g, double tsince, double r[3], double v[3]) {
+    double t = tsince, t2 = t * t;
+    double xmdf = g->mo + g->mdot * t;
+    double argpdf = g->argpo + g->argpdot * t;
+    double nodedf = g->nodeo + g->nodedot * t;
+    double nodem = nodedf + g->nodecf * t2;
+    double delomg = g->omgcof * t;
+    double eta_cos = 1.0 + g->eta * cos(xmdf);
+    double delm = g->xmcof * (eta_cos * eta_cos * eta_cos - g->delmo);
+    double mm = xmdf + delomg + delm;
+    double argpm = argpdf - delomg - delm;
+    double t3 = t2 * t, t4 = t3 * t;
+    double tempa = 1.0 - g->cc1 * t - g->d2 * t2 - g->d3 * t3 - g->d4 * t4;
+    double tempe = g->bstar * g->cc4 * t + g->bstar * g->cc5 * (sin(mm) - g->sinmao);
+    double templ = g->t2cof * t2 + g->t3cof * t3 + t4 * (g->t4cof + t * g->t5cof);
+
+    /* Past the zero of tempa the drag polynomial no longer describes an orbit. */
+    if (tempa <= 0.0) return 0;
+    double am = g->aok * tempa * tempa;
+    double nm = SGP4_XKE / (am * sqrt(am));
+    double em = g->ecco - tempe;
+    if (em >= 1.0 || em < -0.001 || am < 0.95) return 0;
+    if (em < 1.0e-6) em = 1.0e-6;
+    mm += g->no * templ;
+    nodem = sgp4_wrap(nodem);
+    argpm = sgp4_wrap(argpm);
+
+    /* Long-period periodics. */
+    double axnl = em * cos(argpm);
+    double temp = 1.0 / (am * (1.0 - em * em));
+    double aynl = em * sin(argpm) + temp * g->aycof;
+
+    /* Kepler's equation for E + omega; u is the mean longitude less the node. */
+    double u = sgp4_wrap(mm + argpm + temp * g->xlcof * axnl);
+    double eo1 = u, tem5 = 9999.9, sineo1 = 0, coseo1 = 0;
+    for (int ktr = 0; fabs(tem5) >= 1.0e-12 && ktr < 10; ++ktr) {
+        sineo1 = sin(eo1);
+        coseo1 = cos(eo1);
+        tem5 = (u - aynl * coseo1 + axnl * sineo1 - eo1) / (1.0 - coseo1 * axnl - sineo1 * aynl);
+        if (fabs(tem5) >= 0.95) tem5 = tem5 > 0.0 ? 0.95 : -0.95;
+        eo1 += tem5;
+    }
+
+    /* Short-period periodics. */
+    double ecose = axnl * coseo1 + aynl * sineo1;
+    double esine = axnl * sineo1 - aynl * coseo1;
+    double el2 = axnl * axnl + aynl * aynl;
+    double pl = am * (1.0 - el2);
+    if (pl < 0.0) return 0;
+    double rl = am * (1.0 - ecose);
+    double rdotl = sqrt(am) * esine / rl;
+    double rvdotl = sqrt(pl) / rl;
+    double betal = sqrt(1.0 - el2);
+    temp = esine / (1.0 + betal);
+    double sinu = am / rl * (sineo1 - aynl - axnl * temp);
+    double cosu = am / rl * (coseo1 - axnl + aynl * temp);
+    double su = atan2(sinu, cosu);
+    double sin2u = (cosu + cosu) * sinu;
+    double cos2u = 1.0 - 2.0 * sinu * sinu;
+    temp = 1.0 / pl;
+    double temp1 = 0.5 * SGP4_J2 * temp, temp2 = temp1 * temp;
+    double mrt = rl * (1.0 - 1.5 * temp2 * betal * g->con41) + 0.5 * temp1 * g->x1mth2 * cos2u;
+    su -= 0.25 * temp2 * g->x7thm1 * sin2u;
+    double xnode = nodem + 1.5 * temp2 * g->cosio * sin2u;
+    double xinc = g->inclo + 1.5 * temp2 * g->cosio * g->sinio * cos2u;
+    double mvt = rdotl - nm * temp1 * g->x1mth2 * sin2u / SGP4_XKE;
+    double rvdot = rvdotl + nm * temp1 * (g->x1mth2 * cos2u + 1.5 * g->con41) / SGP4_XKE;
+    if (mrt < 1.0) return 0;
+
+    double sinsu = sin(su), cossu = cos(su), snod = sin(xnode), cnod = cos(xnode);
+    double sini = sin(xinc), cosi = cos(xinc);
+    double xmx = -snod * cosi, xmy = cnod * cosi;
+    double ux = xmx * sinsu + cnod * cossu, uy = xmy * sinsu + snod * cossu, uz = sini * sinsu;
+    double vx = xmx * cossu - cnod * sinsu, vy = xmy * cossu - snod * sinsu, vz = sini * cossu;
+    const double vkmpersec = SGP4_RE * SGP4_XKE / 60.0;
+    r[0] = mrt * ux * SGP4_RE;
+    r[1] = mrt * uy * SGP4_RE;
+    r[2] = mrt * uz * SGP4_RE;
+    v[0] = (mvt * ux + rvdot * vx) * vkmpersec;
+    v[1] = (mvt * uy + rvdot * vy) * vkmpersec;
+    v[2] = (mvt * uz + rvdot * vz) * vkmpersec;
+    return 1;
+}
+
+/*
+ * Bounds on the SGP4 radius (km) between tsince0 and tsince1 minutes: the
+ * secular semi-major axis and eccentricity are sampled across the interval,
+ * then widened by the long-period eccentricity and short-period radial terms.
+ */
+static void sgp4_radius_range(const Sgp4 *g, double tsince0, double tsince1, double *rmin, double *rmax) {
+    const int samples = 16;
+    double lo = INFINITY, hi = 0, am_prev = 0, am_step = 0;
+    for (int s = 0; s <= samples; ++s) {
+        double t = tsince0 + (tsince1 - tsince0) * s / samples;
+        double tempa = 1.0 - t * (g->cc1 + t * (g->d2 + t * (g->d3 + t * g->d4)));
+        double am = g->aok * tempa * tempa;
+        double em = g->ecco - g->bstar * g->cc4 * t;
+        double em_var = 2.0 * fabs(g->bstar * g->cc5);
+        double em_hi = fmin(fabs(em) + em_var, 0.999);
+        double el = em_hi + fabs(g->aycof) / (am * (1.0 - em_hi * em_hi));
+        double pl = am * (1.0 - el * el);
+        double temp1 = 0.5 * SGP4_J2 / pl, temp2 = temp1 / pl;
+        double radial = am * (1.0 + el) * 1.5 * temp2 * fabs(g->con41) + 0.5 * temp1 * fabs(g->x1mth2);
+        lo = fmin(lo, am * (1.0 - el) - radial);
+        hi = fmax(hi, am * (1.0 + el) + radial);
+        if (s > 0) am_step = fmax(am_step, fabs(am - am_prev));
+        am_prev = am;
+    }
+    *rmin = (lo - am_step) * SGP4_RE;
+    *rmax = (hi + am_step) * SGP4_RE;
+}
+
+/*
+ * Does the SGP4 object stay in orbit over [t0, t1] (unix seconds)? Besides
+ * a clean solution at both ends, its radius bound must clear the Earth, so
+ * sgp4_state cannot report a decay anywhere in between.
+ */
+static int sgp4_in_orbit(const Satellite *sat, double t0, double t1) {
+    const Sgp4 *g = &sat->sgp4;
+    double ts[2] = { (t0 - sat->epoch_time) / 60.0, (t1 - sat->epoch_time) / 60.0 };
+    double r[3], v[3], rmin, rmax;
+    for (int k = 0; k < 2; ++k) {
+        if (!sgp4_state(g, ts[k], r, v)) return 0;
+        if (g->ecco - g->bstar * g->cc4 * ts[k] - 2.0 * fabs(g->bstar * g->cc5) < -0.001) return 0;
+    }
+    sgp4_radius_range(g, ts[0], ts[1], &rmin, &rmax);
+    return rmin > SGP4_RE;
+}
+
+/* Perifocal unit vectors: p toward perigee, q 90 degrees ahead of it in the orbit plane. */
+static void perifocal_frame(double raan, double argp, double cos_inc, double sin_inc, double p[3], double q[3]) {
+    double cos_raan = cos(raan), sin_raan = sin(raan);
+    double cos_argp = cos(argp), sin_argp = sin(argp);
+    p[0] = cos_raan * cos_argp - sin_raan * sin_argp * cos_inc;
+    p[1] = sin_raan * cos_argp + cos_raan * sin_argp * cos_inc;
+    p[2] = sin_argp * sin_inc;
+    q[0] = -(cos_raan * sin_argp + sin_raan * cos_argp * cos_inc);
+    q[1] = -(sin_raan * sin_argp - cos_raan * cos_argp * cos_inc);
+    q[2] = cos_argp * sin_inc;
+}
+
+static int parse_tle_elements(Satellite *sat) {
+    const char *tle2 = sat->tle2;
+    sat->inclination = deg2rad(get_tle_val(tle2, 8, 8));
+    sat->raan = deg2rad(get_tle_val(tle2, 17, 8));
+    sat->eccentricity = get_tle_fraction(tle2, 26, 7);
+    sat->arg_perigee = deg2rad(get_tle_val(tle2, 34, 8));
+    sat->mean_anomaly = deg2rad(get_tle_val(tle2, 43, 8));
+    sat->mean_motion = get_tle_val(tle2, 52, 11);
+    if (sat->mean_motion <= 0) return 0;
+    double n_rad_per_sec = sat->mean_motion * 2.0 * M_PI / 86400.0;
+    double a_cubed = EARTH_MU / (n_rad_per_sec * n_rad_per_sec);
+    sat->semi_major_axis = cbrt(a_cubed);
+    sat->altitude = sat->semi_major_axis - EARTH_RADIUS;
+    if (sat->altitude < -0.5) return 0;
+
+    PreparedOrbit *o = &sat->orbit;
+    double cos_raan = cos(sat->raan), sin_raan = sin(sat->raan);
+    double cos_inc = cos(sat->inclination), sin_inc = sin(sat->inclination);
+    double e = sat->eccentricity, beta = sqrt(1.0 - e * e);
+    o->n = n_rad_per_sec;
+    o->b = sat->semi_major_axis * beta;
+    perifocal_frame(sat->raan, sat->arg_perigee, cos_inc, sin_inc, o->p, o->q);
+    o->w[0] = sin_inc * sin_raan;
+    o->w[1] = -sin_inc * cos_raan;
+    o->w[2] = cos_inc;
+    sgp4_init(&sat->sgp4, sat);
+    /* TLE mean motions are Kozai's; the J2 rates want Brouwer's, which sgp4_init recovers. */
+    double n0 = sat->sgp4.no / 60.0;
+    o->a_j2 = cbrt(EARTH_MU / (n0 * n0));
+    o->b_j2 = o->a_j2 * beta;
+    double re_p = EARTH_RADIUS / (o->a_j2 * beta * beta);
+    double k = 1.5 * EARTH_J2 * re_p * re_p * n0;
+    o->n_j2 = n0 + k * beta * (1.0 - 1.5 * sin_inc * sin_inc);
+    o->raan_dot = -k * cos_inc;
+    o->argp_dot = 0.5 * k * (4.0 - 5.0 * sin_inc * sin_inc);
+    return 1;
+}
+
+/*
+ * Group keys of a satellite, as a span of its own strings; 0 = no group.
+ * The constellation is the first word of the name, as split by
+ * GROUP_NAME_DELIMITERS. The launch is the year and launch number of the
+ * international designator (TLE line 1, columns 10-14), e.g. 98067 for
+ * every piece of 1998-067.
+ */
+static size_t constellation_key(const Satellite *sat, const char **key) {
+    const char *name = sat->name;
+    while (*name && isspace((unsigned char)*name)) name++;
+    size_t len = strcspn(name, GROUP_NAME_DELIMITERS);
+    *key = name;
+    return len >= GROUP_NAME_MIN_LEN ? len : 0;
+}
+
+static size_t launch_key(const Satellite *sat, const char **key) {
+    *key = sat->tle1 + 9;
+    if (strlen(sat->tle1) < 14) return 0;
+    for (int k = 0; k < 5; ++k) {
+        if (!isdigit((unsigned char)(*key)[k])) return 0;
+    }
+    return 5;
+}
+
+typedef size_t (*GroupKeyFn)(const Satellite *sat, const char **key);
+
+/* Interns key_of over sats into ids: each group is named by the index of its first member. */
+static int intern_groups(const Satellite *sats, int count, GroupKeyFn key_of, int *ids) {
+    size_t size = 64;
+    while (size < (size_t)count * 2) size <<= 1;
+    int *slots = malloc(sizeof(int) * size);
+    if (!slots) return 0;
+    for (size_t k = 0; k < size; ++k) slots[k] = -1;
+    for (int i = 0; i < count; ++i) {
+        const char *key;
+        size_t len = key_of(&sats[i], &key);
+        ids[i] = -1;
+        if (len == 0) continue;
+        unsigned long long h = 1469598103934665603ULL; /* FNV-1a */
+        for (size_t k = 0; k < len; ++k) h = (h ^ (unsigned char)key[k]) * 1099511628211ULL;
+        size_t slot = h & (size - 1);
+        while (slots[slot] != -1) {
+            const char *other;
+            size_t other_len = key_of(&sats[slots[slot]], &other);
+            if (other_len == len && memcmp(other, key, len) == 0) break;
+            slot = (slot + 1) & (size - 1);
+        }
+        if (slots[slot] == -1) slots[slot] = i;
+        ids[i] = slots[slot];
+    }
+    free(slots);
+    return 1;
+}
+
+/* Sets every satellite's constellation and launch ids; without memory they stay ungrouped. */
+static void catalog_assign_groups(Satellite sats[], int count) {
+    int *ids = malloc(sizeof(int) * (count > 0 ? count : 1));
+    for (int i = 0; i < count; ++i) sats[i].constellation = sats[i].launch = -1;
+    if (!ids) return;
+    if (intern_groups(sats, count, constellation_key, ids)) {
+        for (int i = 0; i < count; ++i) sats[i].constellation = ids[i];
+    }
+    if (intern_groups(sats, count, launch_key, ids)) {
+        for (int i = 0; i < count; ++i) sats[i].launch = ids[i];
+    }
+    free(ids);
+}
+
+/*
+ * Returns `items` grown to hold at least `need` elements of `size` bytes,
+ * with the new ones zeroed, and updates *capacity; NULL, leaving both as they
+ * were, when memory runs out. Capacity doubles, so appending stays cheap.
+ */
+static void *grow_array(void *items, int *capacity, int need, size_t size) {
+    if (items && need <= *capacity) return items;
+    size_t grown = *capacity > 0 ? (size_t)*capacity : CATALOG_MIN_CAPACITY;
+    while (grown < (size_t)need) grown *= 2;
+    if (grown > INT_MAX) grown = INT_MAX;
+    if (grown > SIZE_MAX / size) return NULL;
+    char *p = realloc(items, grown * size);
+    if (!p) return NULL;
+    size_t kept = items ? (size_t)*capacity : 0;
+    memset(p + kept * size, 0, (grown - kept) * size);
+    *capacity = (int)grown;
+    return p;
+}
+
+/* A read-only mapping of a whole file; data is NULL when it is empty. */
+typedef struct {
+    const char *data;
+    size_t size;
+} MappedFile;
+
+typedef struct {
+    const char *start;
+    size_t len;        /* without the line ending */
+} MappedLine;
+
+static int map_file(const char *filename, MappedFile *file) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return 0;
+    struct stat st;
+    if (fstat(fd, &st) != 0) { close(fd); return 0; }
+    file->size = (size_t)st.st_size;
+    file->data = file->size > 0 ? mmap(NULL, file->size, PROT_READ, MAP_PRIVATE, fd, 0) : NULL;
+    close(fd);
+    if (file->data == MAP_FAILED) return 0;
+    if (file->data) madvise((void *)file->data, file->size, MADV_SEQUENTIAL);
+    return 1;
+}
+
+static void unmap_file(MappedFile *file) {
+    if (file->data) munmap((void *)file->data, file->size);
+}
+
+/* Next line of a mapped file; 0 at the end of the file. */
+static int next_mapped_line(const char **cursor, const char *end, MappedLine *line) {
+    const char *p = *cursor;
+    if (p >= end) return 0;
+    const char *eol = memchr(p, '\n', end - p);
+    if (!eol) eol = end;
+    line->start = p;
+    line->len = eol - p;
+    while (line->len > 0 && p[line->len - 1] == '\r') line->len--;
+    *cursor = eol < end ? eol + 1 : end;
+    return 1;
+}
+
+static void copy_mapped_line(char *dst, size_t size, const MappedLine *line) {
+    size_t len = line->len < size - 1 ? line->len : size - 1;
+    memcpy(dst, line->start, len);
+    dst[len] = '\0';
+}
+
+/* Days from 1970-01-01 to January 1 of `year` in the proleptic Gregorian calendar. */
+static long days_to_year(int year) {
+    long y = year - 1;
+    return 365L * (y - 1969) + (y / 4 - 492) - (y / 100 - 19) + (y / 400 - 4);
+}
+
+/*
+ * Loaders find the record boundaries in one sequential pass over the mapped
+ * file, which costs little more than memchr, then parse the records on the
+ * worker pool: workers claim contiguous chunks of records and write them
+ * straight into their final slots, so the output keeps the file's order.
+ */
+#define RECORD_CHUNK 1024 /* records a worker claims at a time */
+
+typedef struct {
+    const MappedLine *lines; /* per record: TLE name, line 1 and line 2; SATCAT: one line */
+    void *out;
+    int count;
+    int next;                /* first unclaimed record */
+} RecordParseJob;
+
+/* Claims the next chunk of records, [*from, *to); 0 once all are claimed. */
+static int record_chunk(RecordParseJob *job, int *from, int *to) {
+    *from = __atomic_fetch_add(&job->next, RECORD_CHUNK, __ATOMIC_RELAXED);
+    if (*from >= job->count) return 0;
+    *to = *from + RECORD_CHUNK < job->count ? *from + RECORD_CHUNK : job->count;
+    return 1;
+}
+
+/* Copies a record's three lines into its Satellite and parses every field from there in place. */
+static void parse_tle_record(const MappedLine line[3], Satellite *sat) {
+    copy_mapped_line(sat->name, NAME_LEN, &line[0]);
+    copy_mapped_line(sat->tle1, LINE_LEN, &line[1]);
+    copy_mapped_line(sat->tle2, LINE_LEN, &line[2]);
+    sat->norad_id = get_tle_int(sat->tle1, 2, 5);
+    /* Epoch: two-digit year at column 19, then the day of the year with its fraction. */
+    int epoch_year = get_tle_int(sat->tle1, 18, 2);
+    double epoch_day = get_tle_val(sat->tle1, 20, 12);
+    int full_year = (epoch_year < 57) ? (2000 + epoch_year) : (1900 + epoch_year);
+    sat->epoch_time = (double)(days_to_year(full_year) * 86400L) + (epoch_day - 1.0) * 86400.0;
+    sat->valid = parse_tle_elements(sat);
+}
+
+static int tle_parse_worker(void *ctx, int worker) {
+    (void)worker;
+    RecordParseJob *job = ctx;
+    Satellite *sats = job->out;
+    int from, to;
+    if (!record_chunk(job, &from, &to)) return 0;
+    for (int r = from; r < to; ++r) parse_tle_record(&job->lines[3 * r], &sats[r]);
+    return 1;
+}
+
+/*
+ * A record is a non-empty name line and the two lines after it. Every record
+ * is loaded into *sats, grown to fit with *capacity; returns the count, or -1
+ * with *sats untouched when the file cannot be read or memory runs out.
+ */
+static int load_tle_file(const char *filename, Satellite **sats, int *capacity) {
+    MappedFile file;
+    if (!map_file(filename, &file)) return -1;
+    const char *cursor = file.data, *end = file.data + file.size;
+    MappedLine *lines = NULL;
+    int count = 0, line_capacity = 0, more = 1;
+    while (more) {
+        MappedLine *grown = grow_array(lines, &line_capacity, 3 * (count + 1), sizeof(MappedLine));
+        if (!grown) { free(lines); unmap_file(&file); return -1; }
+        lines = grown;
+        MappedLine *record = &lines[3 * count];
+        while ((more = next_mapped_line(&cursor, end, &record[0])) && record[0].len == 0) {}
+        more = more && next_mapped_line(&cursor, end, &record[1]) && next_mapped_line(&cursor, end, &record[2]);
+        count += more;
+    }
+    Satellite *out = grow_array(*sats, capacity, count, sizeof(Satellite));
+    if (!out) { free(lines); unmap_file(&file); return -1; }
+    *sats = out;
+    RecordParseJob job = { lines, out, count, 0 };
+    worker_pool_run(&SCREEN_POOL, tle_parse_worker, &job);
+    free(lines);
+    unmap_file(&file);
+    catalog_assign_groups(out, count);
+    return count;
+}
+
+// --- NEW: Load SATCAT data from sat_data.txt ---
+static void parse_satcat_record(const MappedLine *line, SatCatData *rec) {
+    const char *text = line->start;
+    rec->norad_id = get_tle_int(text, 13, 5);
+
+    memcpy(rec->official_name, text + 23, 25);
+    rec->official_name[25] = '\0';
+
+    memcpy(rec->country, text + 49, 5);
+    rec->country[5] = '\0';
+
+    memcpy(rec->launch_date, text + 64, 10);
+    rec->launch_date[10] = '\0';
+
+    // Simple status check based on decay date
+    if (text[83] == ' ' || text[83] == '0') {
+        strcpy(rec->status, "Active");
+    } else {
+        strcpy(rec->status, "Decayed/Inactive");
+    }
+
+    // Dummy purpose for demonstration
+    switch(rec->norad_id % 5) {
+        case 0: strcpy(rec->purpose, "Communications"); break;
+        case 1: strcpy(rec->purpose, "Earth Observation"); break;
+        case 2: strcpy(rec->purpose, "Navigation"); break;
+        case 3: strcpy(rec->purpose, "Scientific"); break;
+        default: strcpy(rec->purpose, "Commercial"); break;
+    }
+}
+
+static int satcat_parse_worker(void *ctx, int worker) {
+    (void)worker;
+    RecordParseJob *job = ctx;
+    SatCatData *satcat_db = job->out;
+    int from, to;
+    if (!record_chunk(job, &from, &to)) return 0;
+    for (int r = from; r < to; ++r) parse_satcat_record(&job->lines[r], &satcat_db[r]);
+    return 1;
+}
+
+/*
+ * A record is one line; lines under 100 characters, ending included, are
+ * malformed and skipped. Loads like load_tle_file.
+ */
+static int load_satcat_file(const char* filename, SatCatData **satcat_db, int *capacity) {
+    MappedFile file;
+    if (!map_file(filename, &file)) return -1;
+    const char *cursor = file.data, *end = file.data + file.size;
+    MappedLine *lines = NULL;
+    int count = 0, line_capacity = 0;
+    for (;;) {
+        MappedLine *grown = grow_array(lines, &line_capacity, count + 1, sizeof(MappedLine));
+        if (!grown) { free(lines); unmap_file(&file); return -1; }
+        lines = grown;
+        if (!next_mapped_line(&cursor, end, &lines[count])) break;
+        if (cursor - lines[count].start >= 100) count++;
+    }
+    SatCatData *out = grow_array(*satcat_db, capacity, count, sizeof(SatCatData));
+    if (!out) { free(lines); unmap_file(&file); return -1; }
+    *satcat_db = out;
+    RecordParseJob job = { lines, out, count, 0 };
+    worker_pool_run(&SCREEN_POOL, satcat_parse_worker, &job);
+    free(lines);
+    unmap_file(&file);
+    return count;
+}
+
+/*
+ * Two-body position and velocity (km, km/s) at mean anomaly M, for semi-axes
+ * a and b, eccentricity e and mean motion n in the perifocal frame p, q.
+ */
+static void two_body_state(double a, double b, double e, double n, const double p[3], const double q[3], double M,
+                           double r[3], double v[3]) {
+    M -= 2.0 * M_PI * floor(M * (1.0 / (2.0 * M_PI)));
+    double E = M;
+    for (int i = 0; i < 7; i++) {
+        E = E - (E - e * sin(E) - M) / (1.0 - e * cos(E));
+    }
+    double sin_e = sin(E), cos_e = cos(E);
+    double e_dot = n / (1.0 - e * cos_e);
+    double xp = a * (cos_e - e), yp = b * sin_e;
+    double vxp = -a * sin_e * e_dot, vyp = b * cos_e * e_dot;
+    for (int k = 0; k < 3; ++k) {
+        r[k] = xp * p[k] + yp * q[k];
+        v[k] = vxp * p[k] + vyp * q[k];
+    }
+}
+
+/* Two-body state at mean anomaly M in the TLE's own frame; the model behind MODEL_KEPLER. */
+static void kepler_state(const Satellite *sat, double M, double r[3], double v[3]) {
+    const PreparedOrbit *o = &sat->orbit;
+    two_body_state(sat->semi_major_axis, o->b, sat->eccentricity, o->n, o->p, o->q, M, r, v);
+}
+
+/*
+ * MODEL_J2: the two-body orbit with node, perigee and mean anomaly advanced
+ * at their J2 secular rates, dt seconds after the epoch. The velocity
+ * includes the slow turn of the orbit frame.
+ */
+static void j2_state(const Satellite *sat, double dt, double r[3], double v[3]) {
+    const PreparedOrbit *o = &sat->orbit;
+    double raan = sat->raan + o->raan_dot * dt;
+    double cos_inc = o->w[2], sin_inc = sin(sat->inclination);
+    double p[3], q[3];
+    perifocal_frame(raan, sat->arg_perigee + o->argp_dot * dt, cos_inc, sin_inc, p, q);
+    two_body_state(o->a_j2, o->b_j2, sat->eccentricity, o->n_j2, p, q, sat->mean_anomaly + o->n_j2 * dt, r, v);
+    /* Frame spin: raan_dot about z plus argp_dot about the orbit normal. */
+    double w[3] = {
+        o->argp_dot * sin_inc * sin(raan),
+        -o->argp_dot * sin_inc * cos(raan),
+        o->argp_dot * cos_inc + o->raan_dot,
+    };
+    v[0] += w[1] * r[2] - w[2] * r[1];
+    v[1] += w[2] * r[0] - w[0] * r[2];
+    v[2] += w[0] * r[1] - w[1] * r[0];
+}
+
+// --- Chebyshev Ephemeris Cache ---
+/*
+ * Two-body motion repeats every orbit, so one period of Chebyshev segments,
+ * indexed by mean anomaly, serves any horizon. The period is cut into equal
+ * arcs and x, y, z are fitted on each arc at Chebyshev nodes; the arcs are
+ * halved until the fit is within EPHEMERIS_TOL_KM of kepler_state at
+ * off-node check points. An orbit that still misses at
+ * EPHEMERIS_MAX_SEGMENTS keeps the direct Kepler solve.
+ *
+ * Only propagate_state's two-body path reads the fit: deep-space and decayed
+ * objects under SGP4, and any object under the Kepler model. The screening
+ * sweep keeps the SIMD batch Kepler solve, which costs less per object than
+ * a scalar Clenshaw evaluation. So a satellite is fitted the first time that
+ * path asks for it rather than at load, and a catalog update hands the fit
+ * on only with the unchanged satellite.
+ */
+#define EPHEMERIS_DEGREE 12
+#define EPHEMERIS_MIN_SEGMENTS 4
+#define EPHEMERIS_MAX_SEGMENTS 256
+#ifndef EPHEMERIS_TOL_KM
+#define EPHEMERIS_TOL_KM 1e-3
+#endif
+
+struct Ephemeris {
+    double mean_anomaly; /* at epoch, rad */
+    double mean_motion;  /* rad/s */
+    double epoch;        /* unix seconds */
+    double arc;          /* mean anomaly covered by one segment */
+    double max_error_km; /* worst check-point deviation from kepler_state */
+    int segments;
+    int refs;            /* catalogs sharing this fit; it is immutable once fitted */
+    double coeffs[];     /* [segment][axis][EPHEMERIS_DEGREE + 1] */
+};
+
+#define EPHEMERIS_TERMS (EPHEMERIS_DEGREE + 1)
+
+static size_t ephemeris_size(int segments) {
+    return sizeof(Ephemeris) + sizeof(double) * (size_t)segments * 3 * EPHEMERIS_TERMS;
+}
+
+/*
+ * Clenshaw recurrence for the three axis series of one segment at x in
+ * [-1, 1], run side by side so the three dependency chains overlap. Writes
+ * each value and its derivative in x.
+ */
+static void chebyshev_eval3(const double *c, double x, double value[3], double slope[3]) {
+    double b1[3] = {0}, b2[3] = {0}, d1[3] = {0}, d2[3] = {0};
+    for (int j = EPHEMERIS_TERMS - 1; j >= 1; --j) {
+        for (int k = 0; k < 3; ++k) {
+            double b0 = c[k * EPHEMERIS_TERMS + j] + 2.0 * x * b1[k] - b2[k];
+            double d0 = 2.0 * b1[k] + 2.0 * x * d1[k] - d2[k];
+            b2[k] = b1[k]; b1[k] = b0;
+            d2[k] = d1[k]; d1[k] = d0;
+        }
+    }
+    for (int k = 0; k < 3; ++k) {
+        value[k] = c[k * EPHEMERIS_TERMS] + x * b1[k] - b2[k];
+        slope[k] = b1[k] + x * d1[k] - d2[k];
+    }
+}
+
+/* Position and velocity from the fit; same contract as propagate_state. */
+static void ephemeris_state(const Ephemeris *eph, double sim_time, double r[3], double v[3]) {
+    double M = eph->mean_anomaly + eph->mean_motion * (sim_time - eph->epoch);
+    M -= 2.0 * M_PI * floor(M * (1.0 / (2.0 * M_PI)));
+    int seg = (int)(M / eph->arc);
+    if (seg >= eph->segments) seg = eph->segments - 1;
+    double x = 2.0 * (M - seg * eph->arc) / eph->arc - 1.0;
+    double dx_dt = 2.0 * eph->mean_motion / eph->arc;
+    chebyshev_eval3(&eph->coeffs[(size_t)seg * 3 * EPHEMERIS_TERMS], x, r, v);
+    for (int k = 0; k < 3; ++k) v[k] *= dx_dt;
+}
+
+/* Fits `sat` with the given number of segments; NULL when out of memory. */
+static Ephemeris *ephemeris_fit(const Satellite *sat, int segments) {
+    Ephemeris *eph = malloc(ephemeris_size(segments));
+    if (!eph) return NULL;
+    eph->mean_anomaly = sat->mean_anomaly;
+    eph->mean_motion = sat->orbit.n;
+    eph->epoch = sat->epoch_time;
+    eph->arc = 2.0 * M_PI / segments;
+    eph->segments = segments;
+    eph->refs = 1;
+    eph->max_error_km = 0;
+    double basis[EPHEMERIS_TERMS][EPHEMERIS_TERMS]; /* T_j at node k */
+    for (int j = 0; j < EPHEMERIS_TERMS; ++j) {
+        for (int k = 0; k < EPHEMERIS_TERMS; ++k) basis[j][k] = cos(M_PI * j * (k + 0.5) / EPHEMERIS_TERMS);
+    }
+    for (int seg = 0; seg < segments; ++seg) {
+        double node[EPHEMERIS_TERMS][3];
+        for (int k = 0; k < EPHEMERIS_TERMS; ++k) {
+            double x = basis[1][k], v[3];
+            kepler_state(sat, (seg + 0.5 * (x + 1.0)) * eph->arc, node[k], v);
+        }
+        double *c = &eph->coeffs[(size_t)seg * 3 * EPHEMERIS_TERMS];
+        for (int axis = 0; axis < 3; ++axis) {
+            for (int j = 0; j < EPHEMERIS_TERMS; ++j) {
+                double sum = 0;
+                for (int k = 0; k < EPHEMERIS_TERMS; ++k) sum += node[k][axis] * basis[j][k];
+                c[axis * EPHEMERIS_TERMS + j] = (j == 0 ? 1.0 : 2.0) * sum / EPHEMERIS_TERMS;
+            }
+        }
+        /* Check half way between the fitting nodes, where the error peaks. */
+        for (int k = 0; k < 2 * EPHEMERIS_TERMS; ++k) {
+            double x = -1.0 + (k + 0.5) / EPHEMERIS_TERMS, want[3], got[3], v[3];
+            kepler_state(sat, (seg + 0.5 * (x + 1.0)) * eph->arc, want, v);
+            chebyshev_eval3(c, x, got, v);
+            double d = sqrt((got[0] - want[0]) * (got[0] - want[0]) + (got[1] - want[1]) * (got[1] - want[1])
+                            + (got[2] - want[2]) * (got[2] - want[2]));
+            if (d > eph->max_error_km) eph->max_error_km = d;
+        }
+    }
+    return eph;
+}
+
+/* Stands in for the fit of an orbit that missed EPHEMERIS_TOL_KM, so it is tried once. */
+static Ephemeris EPHEMERIS_NONE;
+
+/* Another reference to a fit, for a catalog that keeps the satellite unchanged. */
+static Ephemeris *ephemeris_retain(Ephemeris *eph) {
+    if (eph && eph != &EPHEMERIS_NONE) __atomic_fetch_add(&eph->refs, 1, __ATOMIC_RELAXED);
+    return eph;
+}
+
+static void ephemeris_release(Ephemeris *eph) {
+    if (eph && eph != &EPHEMERIS_NONE && __atomic_sub_fetch(&eph->refs, 1, __ATOMIC_ACQ_REL) == 0) free(eph);
+}
+
+/* The satellite's current fit, or NULL when none has been tried; safe against a concurrent ephemeris_of. */
+static Ephemeris *ephemeris_peek(const Satellite *sat) {
+    return __atomic_load_n(&sat->ephemeris, __ATOMIC_ACQUIRE);
+}
+
+/*
+ * The satellite's fit, made now when this is the first ask: the coarsest one
+ * within EPHEMERIS_TOL_KM, or NULL when it keeps the direct Kepler solve.
+ * Requests share the catalog, so two may fit the same satellite at once;
+ * the first to store its fit wins and the other frees its own.
+ */
+static const Ephemeris *ephemeris_of(const Satellite *sat) {
+    Ephemeris *eph = ephemeris_peek(sat);
+    if (!eph) {
+        Ephemeris *fit = &EPHEMERIS_NONE;
+        for (int segments = EPHEMERIS_MIN_SEGMENTS; segments <= EPHEMERIS_MAX_SEGMENTS; segments *= 2) {
+            Ephemeris *tried = ephemeris_fit(sat, segments);
+            if (!tried) return NULL; /* out of memory: solve directly and try again next time */
+            if (tried->max_error_km <= EPHEMERIS_TOL_KM) { fit = tried; break; }
+            free(tried);
+        }
+        Ephemeris **slot = (Ephemeris **)&sat->ephemeris;
+        if (__atomic_compare_exchange_n(slot, &eph, fit, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            eph = fit;
+        } else {
+            ephemeris_release(fit);
+        }
+    }
+    return eph == &EPHEMERIS_NONE ? NULL : eph;
+}
+
+/*
+ * Position and velocity (km, km/s) at sim_time under `model`. MODEL_SGP4
+ * uses SGP4 for near-Earth orbits and two-body motion for deep space or
+ * after a decay; two-body motion is read from the satellite's ephemeris when
+ * its orbit fits one.
+ */
+static void propagate_state(const Satellite *sat, PropagationModel model, double sim_time, double r[3], double v[3]) {
+    double dt = sim_time - sat->epoch_time;
+    if (model == MODEL_J2) { j2_state(sat, dt, r, v); return; }
+    if (model == MODEL_SGP4 && sat->sgp4.active && sgp4_state(&sat->sgp4, dt / 60.0, r, v)) return;
+    const Ephemeris *eph = ephemeris_of(sat);
+    if (eph) { ephemeris_state(eph, sim_time, r, v); return; }
+    kepler_state(sat, sat->mean_anomaly + sat->orbit.n * dt, r, v);
+}
+
+void propagate_orbit(const Satellite *sat, double sim_time, double *x, double *y, double *z) {
+    if (!sat->valid) return;
+    double r[3], v[3];
+    propagate_state(sat, MODEL_SGP4, sim_time, r, v);
+    *x = r[0];
+    *y = r[1];
+    *z = r[2];
+}
+
+// --- Published Catalog ---
+/*
+ * Requests never lock the catalog. A reader takes a reference to the current
+ * immutable Catalog with catalog_acquire and sees that one catalog,
+ * unchanged, until catalog_release, however long it takes. An update builds
+ * the next catalog off to the side and catalog_publish makes it current, so
+ * requests already running finish on the old catalog, which is freed when
+ * its last reference goes.
+ *
+ * The current catalog sits in one of two slots. A reader takes a ticket
+ * with a single fetch-and-add on CATALOG_TICKETS, which names the slot, then
+ * takes its reference and counts itself in CATALOG_CLAIMED for that slot:
+ * a fixed number of steps, with no lock and no retry, so no reader can be
+ * starved. The publisher fills the other slot and swaps the ticket word,
+ * which tells it how many tickets the old slot gave out. It waits for that
+ * many claims before it drops the old catalog's reference, so the catalog
+ * cannot be freed between a reader's ticket and its increment. The wait
+ * lasts the few instructions of a reader that took a ticket just before the
+ * swap. Publishes must not overlap.
+ */
+static Catalog *catalog_alloc(unsigned long generation) {
+    Catalog *catalog = calloc(1, sizeof(Catalog));
+    if (catalog) {
+        catalog->refs = 1;
+        catalog->generation = generation;
+    }
+    return catalog;
+}
+
+static void catalog_free(Catalog *catalog) {
+    for (int i = 0; i < catalog->count; ++i) ephemeris_release(catalog->sats[i].ephemeris);
+    free(catalog->sats);
+    free(catalog->satcat);
+    free(catalog);
+}
+
+/* A reference to the current catalog; never NULL once startup has published one. */
+static Catalog *catalog_acquire(void) {
+    unsigned long ticket = __atomic_fetch_add(&CATALOG_TICKETS, 2, __ATOMIC_ACQUIRE);
+    Catalog *catalog = __atomic_load_n(&CATALOG_SLOTS[ticket & 1], __ATOMIC_RELAXED);
+    __atomic_fetch_add(&catalog->refs, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&CATALOG_CLAIMED[ticket & 1], 1, __ATOMIC_RELEASE);
+    return catalog;
+}
+
+static void catalog_release(Catalog *catalog) {
+    if (catalog && __atomic_sub_fetch(&catalog->refs, 1, __ATOMIC_ACQ_REL) == 0) catalog_free(catalog);
+}
+
+/* Makes `next` current, taking over the caller's reference to it. Startup and the catalog keeper are the only callers. */
+static void catalog_publish(Catalog *next) {
+    int slot = (int)(__atomic_load_n(&CATALOG_TICKETS, __ATOMIC_RELAXED) & 1);
+    __atomic_store_n(&CATALOG_SLOTS[!slot], next, __ATOMIC_RELAXED);
+    unsigned long issued = __atomic_exchange_n(&CATALOG_TICKETS, (unsigned long)!slot, __ATOMIC_ACQ_REL) >> 1;
+    while (__atomic_load_n(&CATALOG_CLAIMED[slot], __ATOMIC_ACQUIRE) != issued) sched_yield();
+    __atomic_store_n(&CATALOG_CLAIMED[slot], 0, __ATOMIC_RELAXED);
+    catalog_release(CATALOG_SLOTS[slot]);
+}
+
+// --- Catalog Updates ---
+/*
+ * A republished catalog is applied to a copy of the current one, matching
+ * objects by NORAD id: a changed element set overwrites its slot, a new
+ * object is appended and an object missing from the file is invalidated.
+ * Unchanged objects keep their indices, so cached results that involve only
+ * them stay valid and just the changed objects need screening again.
+ */
+
+/* Slot of norad_id in an open-addressing table of `sats` index + 1: its entry, or the empty one it would take. */
+static int *catalog_slot(const Satellite *sats, int *slots, int cap, int norad_id) {
+    unsigned h = (unsigned)norad_id * 2654435761u;
+    for (int k = h & (cap - 1);; k = (k + 1) & (cap - 1)) {
+        if (!slots[k] || sats[slots[k] - 1].norad_id == norad_id) return &slots[k];
+    }
+}
+
+/*
+ * Builds the next catalog from the current one, the TLE file at
+ * `tle_filename` and the SATCAT file at `satcat_filename`, either of which
+ * may be NULL to keep what the current catalog has, and publishes it when
+ * anything changed. Sets *changed to flags, one per slot of the new catalog
+ * and freed by the caller, for every slot the TLE file touched and returns
+ * how many there are; -1, leaving the current catalog in place, when a file
+ * could not be read or memory ran out. Updates must not overlap; the catalog
+ * keeper is the only caller.
+ */
+static int catalog_update(const char *tle_filename, const char *satcat_filename, char **changed) {
+    Satellite *fresh = NULL;
+    int fresh_capacity = 0, count = 0;
+    if (tle_filename && (count = load_tle_file(tle_filename, &fresh, &fresh_capacity)) < 0) return -1;
+    SatCatData *fresh_satcat = NULL;
+    int satcat_capacity = 0, satcat_count = 0;
+    if (satcat_filename && (satcat_count = load_satcat_file(satcat_filename, &fresh_satcat, &satcat_capacity)) < 0) {
+        free(fresh);
+        return -1;
+    }
+    Catalog *old = catalog_acquire();
+    int limit = old->count + count, changes = 0;
+    int cap = 1;
+    while (cap < 2 * limit) cap <<= 1;
+    int *slots = calloc(cap, sizeof(int));
+    char *seen = calloc(limit + 1, 1);
+    char *flags = calloc(limit + 1, 1);
+    Catalog *next = catalog_alloc(old->generation + 1);
+    Satellite *sats = next ? malloc(sizeof(Satellite) * (limit + 1)) : NULL;
+    SatCatData *satcat = satcat_filename ? fresh_satcat : sats ? malloc(sizeof(SatCatData) * (old->satcat_count + 1)) : NULL;
+    if (!slots || !seen || !flags || !sats || !satcat) {
+        catalog_release(old);
+        free(fresh); free(fresh_satcat); free(seen); free(slots); free(flags); free(next); free(sats);
+        if (!satcat_filename) free(satcat);
+        return -1;
+    }
+    memcpy(sats, old->sats, sizeof(Satellite) * old->count);
+    if (!satcat_filename) {
+        memcpy(satcat, old->satcat, sizeof(SatCatData) * old->satcat_count);
+        satcat_count = old->satcat_count;
+    }
+    next->sats = sats;
+    next->count = old->count;
+    next->satcat = satcat;
+    next->satcat_count = satcat_count;
+    for (int i = 0; i < old->count; ++i) {
+        sats[i].ephemeris = NULL; /* shared below unless the object changed */
+        int *slot = catalog_slot(sats, slots, cap, sats[i].norad_id);
+        if (!*slot) *slot = i + 1;
+    }
+    for (int m = 0; m < count; ++m) {
+        int *slot = catalog_slot(sats, slots, cap, fresh[m].norad_id);
+        int k = *slot - 1;
+        if (k < 0) {
+            k = next->count++;
+            *slot = k + 1;
+        } else if (seen[k]) {
+            continue;
+        } else if (sats[k].valid == fresh[m].valid && strcmp(sats[k].tle1, fresh[m].tle1) == 0
+                   && strcmp(sats[k].tle2, fresh[m].tle2) == 0 && strcmp(sats[k].name, fresh[m].name) == 0) {
+            seen[k] = 1;
+            continue;
+        }
+        seen[k] = 1;
+        sats[k] = fresh[m];
+        flags[k] = 1;
+        changes++;
+    }
+    for (int i = 0; i < old->count; ++i) {
+        if (tle_filename && !seen[i] && sats[i].valid) {
+            sats[i].valid = 0;
+            flags[i] = 1;
+            changes++;
+        }
+        if (!(seen[i] && flags[i])) sats[i].ephemeris = ephemeris_retain(ephemeris_peek(&old->sats[i]));
+    }
+    if (changes > 0 || satcat_filename) {
+        catalog_assign_groups(sats, next->count);
+        catalog_publish(next);
+    } else {
+        catalog_free(next);
+    }
+    catalog_release(old);
+    free(fresh); free(seen); free(slots);
+    *changed = flags;
+    return changes;
+}
+
+// --- Catalog Snapshot ---
+/*
+ * The parsed catalog is saved as a binary snapshot after every load: a
+ * header, then the satellites and SATCAT records as they sit in memory
+ * (elements, prepared constants and group ids included). Ephemerides are
+ * left out; they are fitted again on first use. A snapshot newer than the
+ * text files is mapped at the next start and copied in, skipping the
+ * downloads and the parse. The header
+ * carries the format version and a hash of the struct layouts and the
+ * tunables the parse depends on; a snapshot that does not match is ignored.
+ */
+#define SNAPSHOT_MAGIC "SDSCAT1"
+#define SNAPSHOT_VERSION 2
+
+typedef struct {
+    char magic[8];
+    unsigned long version;
+    unsigned long config;      /* snapshot_config() of the writer */
+    unsigned long sats;
+    unsigned long satcat;
+} SnapshotHeader;
+
+static unsigned long snapshot_config(void) {
+    char text[256];
+    snprintf(text, sizeof(text), "%zu %zu [%s] %d", sizeof(Satellite), sizeof(SatCatData),
+             GROUP_NAME_DELIMITERS, GROUP_NAME_MIN_LEN);
+    unsigned long hash = 1469598103934665603UL;
+    for (const char *c = text; *c; ++c) hash = (hash ^ (unsigned char)*c) * 1099511628211UL;
+    return hash;
+}
+
+/* Writes the current catalog to `path` through a temporary file; 0 on failure. */
+static int catalog_snapshot_save(const char *path) {
+    char partial[512];
+    snprintf(partial, sizeof(partial), "%s.part", path);
+    FILE *f = fopen(partial, "wb");
+    if (!f) return 0;
+    Catalog *catalog = catalog_acquire();
+    SnapshotHeader header = {
+        .magic = SNAPSHOT_MAGIC,
+        .version = SNAPSHOT_VERSION,
+        .config = snapshot_config(),
+        .sats = (unsigned long)catalog->count,
+        .satcat = (unsigned long)catalog->satcat_count,
+    };
+    int ok = fwrite(&header, sizeof(header), 1, f) == 1
+          && fwrite(catalog->sats, sizeof(Satellite), header.sats, f) == header.sats
+          && fwrite(catalog->satcat, sizeof(SatCatData), header.satcat, f) == header.satcat;
+    catalog_release(catalog);
+    ok = fclose(f) == 0 && ok && rename(partial, path) == 0;
+    if (!ok) remove(partial);
+    return ok;
+}
+
+/* 1 when the snapshot was modified no earlier than `source`, or `source` does not exist. */
+static int file_is_current(const struct stat *snapshot, const char *source) {
+    struct stat st;
+    if (stat(source, &st) != 0) return 1;
+    if (snapshot->st_mtim.tv_sec != st.st_mtim.tv_sec) return snapshot->st_mtim.tv_sec > st.st_mtim.tv_sec;
+    return snapshot->st_mtim.tv_nsec >= st.st_mtim.tv_nsec;
+}
+
+/*
+ * Loads the catalog from the snapshot at `path` when it matches this build
+ * and is at least as new as both text files. Returns NULL when the text
+ * files must be parsed instead.
+ */
+static Catalog *catalog_snapshot_load(const char *path, const char *tle_filename, const char *satcat_filename) {
+    struct stat st;
+    if (stat(path, &st) != 0 || !file_is_current(&st, tle_filename) || !file_is_current(&st, satcat_filename)) return NULL;
+    MappedFile file;
+    if (!map_file(path, &file)) return NULL;
+    const SnapshotHeader *header = (const SnapshotHeader *)file.data;
+    int ok = file.size >= sizeof(SnapshotHeader) && memcmp(header->magic, SNAPSHOT_MAGIC, 8) == 0
+          && header->version == SNAPSHOT_VERSION && header->config == snapshot_config()
+          && header->sats <= file.size / sizeof(Satellite) && header->satcat <= file.size / sizeof(SatCatData)
+          && file.size == sizeof(SnapshotHeader) + header->sats * sizeof(Satellite)
+                          + header->satcat * sizeof(SatCatData);
+    const Satellite *sats = ok ? (const Satellite *)(header + 1) : NULL;
+    Catalog *catalog = ok ? catalog_alloc(1) : NULL;
+    Satellite *db = catalog ? malloc(sizeof(Satellite) * (header->sats + 1)) : NULL;
+    SatCatData *satcat = db ? malloc(sizeof(SatCatData) * (header->satcat + 1)) : NULL;
+    if (satcat) {
+        memcpy(db, sats, header->sats * sizeof(Satellite));
+        memcpy(satcat, sats + header->sats, header->satcat * sizeof(SatCatData));
+        for (unsigned long i = 0; i < header->sats; ++i) db[i].ephemeris = NULL;
+        catalog->sats = db;
+        catalog->count = (int)header->sats;
+        catalog->satcat = satcat;
+        catalog->satcat_count = (int)header->satcat;
+    } else {
+        free(catalog); free(db);
+        catalog = NULL;
+    }
+    unmap_file(&file);
+    return catalog;
+}
+
+// --- Batch Propagation (structure of arrays, SIMD) ---
+/*
+ * The vector layer below lets one kernel compile to AVX-512 (8 lanes), AVX2
+ * (4 lanes) or plain scalar code, picked from the target flags at build time.
+ */
+#if defined(__AVX512F__)
+#define VLANES 8
+typedef __m512d vdouble;
+typedef __mmask8 vmask;
+#define v_load(p)         _mm512_loadu_pd(p)
+#define v_store(p, a)     _mm512_storeu_pd(p, a)
+#define v_set1(x)         _mm512_set1_pd(x)
+#define v_add(a, b)       _mm512_add_pd(a, b)
+#define v_sub(a, b)       _mm512_sub_pd(a, b)
+#define v_mul(a, b)       _mm512_mul_pd(a, b)
+#define v_div(a, b)       _mm512_div_pd(a, b)
+#define v_fma(a, b, c)    _mm512_fmadd_pd(a, b, c)
+#define v_sqrt(a)         _mm512_sqrt_pd(a)
+#define v_min(a, b)       _mm512_min_pd(a, b)
+#define v_max(a, b)       _mm512_max_pd(a, b)
+#define v_floor(a)        _mm512_roundscale_pd(a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC)
+#define v_round(a)        _mm512_roundscale_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)
+#define v_gt(a, b)        _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ)
+#define v_select(m, a, b) _mm512_mask_blend_pd(m, b, a)
+#elif defined(__AVX2__)
+#define VLANES 4
+typedef __m256d vdouble;
+typedef __m256d vmask;
+#define v_load(p)         _mm256_loadu_pd(p)
+#define v_store(p, a)     _mm256_storeu_pd(p, a)
+#define v_set1(x)         _mm256_set1_pd(x)
+#define v_add(a, b)       _mm256_add_pd(a, b)
+#define v_sub(a, b)       _mm256_sub_pd(a, b)
+#define v_mul(a, b)       _mm256_mul_pd(a, b)
+#define v_div(a, b)       _mm256_div_pd(a, b)
+#define v_sqrt(a)         _mm256_sqrt_pd(a)
+#define v_min(a, b)       _mm256_min_pd(a, b)
+#define v_max(a, b)       _mm256_max_pd(a, b)
+#ifdef __FMA__
+#define v_fma(a, b, c)    _mm256_fmadd_pd(a, b, c)
+#else
+#define v_fma(a, b, c)    _mm256_add_pd(_mm256_mul_pd(a, b), c)
+#endif
+#define v_floor(a)        _mm256_floor_pd(a)
+#define v_round(a)        _mm256_round_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)
+#define v_gt(a, b)        _mm256_cmp_pd(a, b, _CMP_GT_OQ)
+#define v_select(m, a, b) _mm256_blendv_pd(b, a, m)
+#else
+#define VLANES 1
+typedef double vdouble;
+typedef int vmask;
+#define v_load(p)         (*(p))
+#define v_store(p, a)     (*(p) = (a))
+#define v_set1(x)         (x)
+#define v_add(a, b)       ((a) + (b))
+#define v_sub(a, b)       ((a) - (b))
+#define v_mul(a, b)       ((a) * (b))
+#define v_div(a, b)       ((a) / (b))
+#define v_fma(a, b, c)    ((a) * (b) + (c))
+#define v_sqrt(a)         sqrt(a)
+#define v_min(a, b)       fmin(a, b)
+#define v_max(a, b)       fmax(a, b)
+#define v_floor(a)        floor(a)
+#define v_round(a)        nearbyint(a)
+#define v_gt(a, b)        ((a) > (b))
+#define v_select(m, a, b) ((m) ? (a) : (b))
+#endif
+
+/* sin and cos together: Cody-Waite reduction by pi/2 and the fdlibm kernels on [-pi/4, pi/4]. */
+static inline void v_sincos(vdouble x, vdouble *s, vdouble *c) {
+    const vdouble zero = v_set1(0.0), half = v_set1(0.5), one = v_set1(1.0);
+    vdouble q = v_round(v_mul(x, v_set1(6.36619772367581382433e-01)));
+    vdouble r = v_fma(q, v_set1(-1.57079632673412561417e+00), x);
+    r = v_fma(q, v_set1(-6.07710050650619224932e-11), r);
+    vdouble z = v_mul(r, r);
+    vdouble ps = v_fma(z, v_set1(1.58969099521155010221e-10), v_set1(-2.50507602534068634195e-08));
+    ps = v_fma(z, ps, v_set1(2.75573137070700676789e-06));
+    ps = v_fma(z, ps, v_set1(-1.98412698298579493134e-04));
+    ps = v_fma(z, ps, v_set1(8.33333333332248946124e-03));
+    ps = v_fma(z, ps, v_set1(-1.66666666666666324348e-01));
+    ps = v_fma(v_mul(z, r), ps, r);
+    vdouble pc = v_fma(z, v_set1(-1.13596475577881948265e-11), v_set1(2.08757232129817482790e-09));
+    pc = v_fma(z, pc, v_set1(-2.75573143513906633035e-07));
+    pc = v_fma(z, pc, v_set1(2.48015872894767294178e-05));
+    pc = v_fma(z, pc, v_set1(-1.38888888888741095749e-03));
+    pc = v_fma(z, pc, v_set1(4.16666666666666019037e-02));
+    pc = v_fma(v_mul(z, z), pc, v_fma(v_set1(-0.5), z, one));
+    /* Quadrant bits of q: bit0 swaps sin/cos, bit1 flips sin, bit0 ^ bit1 flips cos. */
+    vdouble q2 = v_floor(v_mul(q, half));
+    vdouble bit0 = v_sub(q, v_add(q2, q2));
+    vdouble bit1 = v_sub(q2, v_mul(v_floor(v_mul(q2, half)), v_set1(2.0)));
+    vmask swap = v_gt(bit0, half);
+    vdouble sv = v_select(swap, pc, ps);
+    vdouble cv = v_select(swap, ps, pc);
+    vdouble diff = v_sub(bit0, bit1);
+    *s = v_select(v_gt(bit1, half), v_sub(zero, sv), sv);
+    *c = v_select(v_gt(v_mul(diff, diff), half), v_sub(zero, cv), cv);
+}
+
+/* Angle wrapped to [0, 2 pi). */
+static inline vdouble v_wrap_two_pi(vdouble a) {
+    return v_sub(a, v_mul(v_set1(2.0 * M_PI), v_floor(v_mul(a, v_set1(1.0 / (2.0 * M_PI))))));
+}
+
+/* SGP4 setup of the near-Earth objects of a batch, one array per Sgp4 field the propagator reads. */
+typedef struct {
+    double *epoch, *mo, *mdot, *argpo, *argpdot, *nodeo, *nodedot, *nodecf;
+    double *omgcof, *xmcof, *eta, *delmo, *sinmao;
+    double *cc1, *d2, *d3, *d4, *bcc4, *bcc5; /* bcc4, bcc5: cc4 and cc5 times bstar */
+    double *t2cof, *t3cof, *t4cof, *t5cof;
+    double *aok, *no, *ecco, *inclo, *aycof, *xlcof;
+    double *con41, *x1mth2, *x7thm1, *cosio, *sinio;
+} Sgp4Batch;
+
+#define SGP4_BATCH_FIELDS 34
+
+/*
+ * Structure-of-arrays view of a set of orbits. The first sgp4_count objects
+ * are near-Earth SGP4 objects; the rest use the two-body model with the
+ * perifocal frame precomputed: position = a (cos E - e) P + b sin E Q.
+ * In a J2 batch the frame turns with the secular rates instead and is
+ * rebuilt from the node and perigee angles at every call.
+ * Arrays are padded to a multiple of VLANES; padding lanes are scratch.
+ */
+typedef struct {
+    int count;
+    int padded;
+    int sgp4_count;
+    int j2;
+    double *mean_anomaly, *mean_motion, *epoch, *ecc, *a, *b;
+    double *px, *py, *pz, *qx, *qy, *qz;
+    double *raan, *argp, *raan_dot, *argp_dot, *cos_inc, *sin_inc; /* J2 batches only */
+    Sgp4Batch sgp4;
+    double *storage;
+} OrbitBatch;
+
+#define ORBIT_BATCH_FIELDS 18
+
+/* Zeroed storage for n objects under `model`, the first n_sgp4 of them SGP4 objects. */
+static int orbit_batch_alloc(OrbitBatch *batch, int n, int n_sgp4, PropagationModel model) {
+    int sgp4_padded = (n_sgp4 + 8 - 1) / 8 * 8;
+    /* The two-body part starts right after the SGP4 objects, so its last vector may overhang count. */
+    int padded = n_sgp4 + (n - n_sgp4 + 8 - 1) / 8 * 8;
+    if (padded < sgp4_padded) padded = sgp4_padded;
+    padded = (padded + 8 - 1) / 8 * 8;
+    if (padded == 0) padded = 8;
+    size_t doubles = (size_t)ORBIT_BATCH_FIELDS * padded + (size_t)SGP4_BATCH_FIELDS * sgp4_padded;
+    batch->storage = aligned_alloc(64, sizeof(double) * doubles);
+    if (!batch->storage) return 0;
+    memset(batch->storage, 0, sizeof(double) * doubles);
+    double **fields[ORBIT_BATCH_FIELDS] = {
+        &batch->mean_anomaly, &batch->mean_motion, &batch->epoch, &batch->ecc, &batch->a, &batch->b,
+        &batch->px, &batch->py, &batch->pz, &batch->qx, &batch->qy, &batch->qz,
+        &batch->raan, &batch->argp, &batch->raan_dot, &batch->argp_dot, &batch->cos_inc, &batch->sin_inc,
+    };
+    for (int f = 0; f < ORBIT_BATCH_FIELDS; ++f) *fields[f] = batch->storage + (size_t)f * padded;
+    Sgp4Batch *s = &batch->sgp4;
+    double **sgp4_fields[SGP4_BATCH_FIELDS] = {
+        &s->epoch, &s->mo, &s->mdot, &s->argpo, &s->argpdot, &s->nodeo, &s->nodedot, &s->nodecf,
+        &s->omgcof, &s->xmcof, &s->eta, &s->delmo, &s->sinmao,
+        &s->cc1, &s->d2, &s->d3, &s->d4, &s->bcc4, &s->bcc5,
+        &s->t2cof, &s->t3cof, &s->t4cof, &s->t5cof,
+        &s->aok, &s->no, &s->ecco, &s->inclo, &s->aycof, &s->xlcof,
+        &s->con41, &s->x1mth2, &s->x7thm1, &s->cosio, &s->sinio,
+    };
+    double *sgp4_base = batch->storage + (size_t)ORBIT_BATCH_FIELDS * padded;
+    for (int f = 0; f < SGP4_BATCH_FIELDS; ++f) *sgp4_fields[f] = sgp4_base + (size_t)f * sgp4_padded;
+    batch->count = n;
+    batch->padded = padded;
+    batch->sgp4_count = n_sgp4;
+    batch->j2 = model == MODEL_J2;
+    return 1;
+}
+
+/*
+ * Builds a batch from sats[idx[0..n-1]] for `model`; all of them must be
+ * valid, and the first n_sgp4 must have sgp4.active set (n_sgp4 is 0 unless
+ * model is MODEL_SGP4).
+ */
+static int orbit_batch_build(OrbitBatch *batch, const Satellite *sats, const int *idx, int n, int n_sgp4,
+                             PropagationModel model) {
+    if (!orbit_batch_alloc(batch, n, n_sgp4, model)) return 0;
+    Sgp4Batch *s = &batch->sgp4;
+    int sgp4_padded = (n_sgp4 + 8 - 1) / 8 * 8;
+    /* SGP4 padding lanes repeat the last object so they stay finite. */
+    for (int k = 0; k < sgp4_padded; ++k) {
+        const Satellite *sat = &sats[idx[k < n_sgp4 ? k : n_sgp4 - 1]];
+        const Sgp4 *g = &sat->sgp4;
+        s->epoch[k] = sat->epoch_time;
+        s->mo[k] = g->mo;
+        s->mdot[k] = g->mdot;
+        s->argpo[k] = g->argpo;
+        s->argpdot[k] = g->argpdot;
+        s->nodeo[k] = g->nodeo;
+        s->nodedot[k] = g->nodedot;
+        s->nodecf[k] = g->nodecf;
+        s->omgcof[k] = g->omgcof;
+        s->xmcof[k] = g->xmcof;
+        s->eta[k] = g->eta;
+        s->delmo[k] = g->delmo;
+        s->sinmao[k] = g->sinmao;
+        s->cc1[k] = g->cc1;
+        s->d2[k] = g->d2;
+        s->d3[k] = g->d3;
+        s->d4[k] = g->d4;
+        s->bcc4[k] = g->bstar * g->cc4;
+        s->bcc5[k] = g->bstar * g->cc5;
+        s->t2cof[k] = g->t2cof;
+        s->t3cof[k] = g->t3cof;
+        s->t4cof[k] = g->t4cof;
+        s->t5cof[k] = g->t5cof;
+        s->aok[k] = g->aok;
+        s->no[k] = g->no;
+        s->ecco[k] = g->ecco;
+        s->inclo[k] = g->inclo;
+        s->aycof[k] = g->aycof;
+        s->xlcof[k] = g->xlcof;
+        s->con41[k] = g->con41;
+        s->x1mth2[k] = g->x1mth2;
+        s->x7thm1[k] = g->x7thm1;
+        s->cosio[k] = g->cosio;
+        s->sinio[k] = g->sinio;
+    }
+    for (int k = n_sgp4; k < n; ++k) {
+        const Satellite *sat = &sats[idx[k]];
+        const PreparedOrbit *o = &sat->orbit;
+        batch->mean_anomaly[k] = sat->mean_anomaly;
+        batch->mean_motion[k] = o->n;
+        batch->epoch[k] = sat->epoch_time;
+        batch->ecc[k] = sat->eccentricity;
+        batch->a[k] = sat->semi_major_axis;
+        batch->b[k] = o->b;
+        batch->px[k] = o->p[0];
+        batch->py[k] = o->p[1];
+        batch->pz[k] = o->p[2];
+        batch->qx[k] = o->q[0];
+        batch->qy[k] = o->q[1];
+        batch->qz[k] = o->q[2];
+        if (batch->j2) {
+            batch->mean_motion[k] = o->n_j2;
+            batch->a[k] = o->a_j2;
+            batch->b[k] = o->b_j2;
+            batch->raan[k] = sat->raan;
+            batch->argp[k] = sat->arg_perigee;
+            batch->raan_dot[k] = o->raan_dot;
+            batch->argp_dot[k] = o->argp_dot;
+            batch->cos_inc[k] = o->w[2];
+            batch->sin_inc[k] = sin(sat->inclination);
+        }
+    }
+    return 1;
+}
+
+/*
+ * Copies objects list[0..m-1] of src, ascending, to the front of dst, which
+ * orbit_batch_alloc sized like src. Columns share their offsets in both.
+ */
+static void orbit_batch_gather(OrbitBatch *dst, const OrbitBatch *src, const int *list, int m) {
+    int sgp4_padded = (src->sgp4_count + 8 - 1) / 8 * 8;
+    int m_sgp4 = 0;
+    while (m_sgp4 < m && list[m_sgp4] < src->sgp4_count) m_sgp4++;
+    int tail = (m_sgp4 + VLANES - 1) / VLANES * VLANES;
+    for (int f = 0; f < SGP4_BATCH_FIELDS; ++f) {
+        size_t column = (size_t)ORBIT_BATCH_FIELDS * src->padded + (size_t)f * sgp4_padded;
+        const double *from = src->storage + column;
+        double *to = dst->storage + column;
+        for (int i = 0; i < m_sgp4; ++i) to[i] = from[list[i]];
+        /* Padding lanes repeat the last object so they stay finite. */
+        for (int i = m_sgp4; i < tail; ++i) to[i] = to[m_sgp4 - 1];
+    }
+    for (int f = 0; f < ORBIT_BATCH_FIELDS; ++f) {
+        const double *from = src->storage + (size_t)f * src->padded;
+        double *to = dst->storage + (size_t)f * src->padded;
+        for (int i = m_sgp4; i < m; ++i) to[i] = from[list[i]];
+    }
+    dst->count = m;
+    dst->sgp4_count = m_sgp4;
+}
+
+static void orbit_batch_free(OrbitBatch *batch) {
+    free(batch->storage);
+    batch->storage = NULL;
+}
+
+/*
+ * SGP4 for VLANES objects of the batch starting at k; same model as
+ * sgp4_state, but branch-free: Kepler's equation gets a fixed eight
+ * iterations, the simplified-drag objects carry zero higher-order
+ * coefficients, and the decay checks are left to the caller.
+ */
+static inline void propagate_sgp4_lanes(const Sgp4Batch *s, int k, vdouble sim_time, double *x, double *y, double *z,
+                                        double *vx, double *vy, double *vz) {
+    const vdouble one = v_set1(1.0), half = v_set1(0.5), one_half = v_set1(1.5);
+    const vdouble xke = v_set1(SGP4_XKE), j2 = v_set1(SGP4_J2);
+    vdouble t = v_mul(v_sub(sim_time, v_load(&s->epoch[k])), v_set1(1.0 / 60.0));
+    vdouble t2 = v_mul(t, t);
+    vdouble xmdf = v_fma(v_load(&s->mdot[k]), t, v_load(&s->mo[k]));
+    vdouble argpdf = v_fma(v_load(&s->argpdot[k]), t, v_load(&s->argpo[k]));
+    vdouble nodem = v_fma(v_load(&s->nodecf[k]), t2, v_fma(v_load(&s->nodedot[k]), t, v_load(&s->nodeo[k])));
+    vdouble delomg = v_mul(v_load(&s->omgcof[k]), t);
+    vdouble sin_v, cos_v;
+    v_sincos(v_wrap_two_pi(xmdf), &sin_v, &cos_v);
+    vdouble eta_cos = v_fma(v_load(&s->eta[k]), cos_v, one);
+    vdouble delm = v_mul(v_load(&s->xmcof[k]), v_sub(v_mul(v_mul(eta_cos, eta_cos), eta_cos), v_load(&s->delmo[k])));
+    vdouble mm = v_add(v_add(xmdf, delomg), delm);
+    vdouble argpm = v_wrap_two_pi(v_sub(v_sub(argpdf, delomg), delm));
+    vdouble tempa = v_fma(v_load(&s->d4[k]), t, v_load(&s->d3[k]));
+    tempa = v_fma(tempa, t, v_load(&s->d2[k]));
+    tempa = v_fma(tempa, t, v_load(&s->cc1[k]));
+    tempa = v_sub(one, v_mul(tempa, t));
+    v_sincos(v_wrap_two_pi(mm), &sin_v, &cos_v);
+    vdouble tempe = v_fma(v_load(&s->bcc4[k]), t, v_mul(v_load(&s->bcc5[k]), v_sub(sin_v, v_load(&s->sinmao[k]))));
+    vdouble templ = v_fma(v_load(&s->t5cof[k]), t, v_load(&s->t4cof[k]));
+    templ = v_fma(templ, t, v_load(&s->t3cof[k]));
+    templ = v_mul(v_fma(templ, t, v_load(&s->t2cof[k])), t2);
+
+    vdouble am = v_mul(v_load(&s->aok[k]), v_mul(tempa, tempa));
+    vdouble nm = v_div(xke, v_mul(am, v_sqrt(am)));
+    vdouble em = v_max(v_sub(v_load(&s->ecco[k]), tempe), v_set1(1.0e-6));
+    mm = v_fma(v_load(&s->no[k]), templ, mm);
+
+    /* Long-period periodics. */
+    v_sincos(argpm, &sin_v, &cos_v);
+    vdouble axnl = v_mul(em, cos_v);
+    vdouble temp = v_div(one, v_mul(am, v_sub(one, v_mul(em, em))));
+    vdouble aynl = v_fma(em, sin_v, v_mul(temp, v_load(&s->aycof[k])));
+    vdouble u = v_wrap_two_pi(v_add(v_add(mm, argpm), v_mul(v_mul(temp, v_load(&s->xlcof[k])), axnl)));
+
+    /* Kepler's equation for E + omega, steps clamped to 0.95 as in sgp4_state. */
+    vdouble eo1 = u, sineo1, coseo1;
+    for (int it = 0; it < 8; ++it) {
+        v_sincos(eo1, &sineo1, &coseo1);
+        vdouble f = v_sub(v_fma(axnl, sineo1, v_sub(u, v_mul(aynl, coseo1))), eo1);
+        vdouble fp = v_sub(v_sub(one, v_mul(coseo1, axnl)), v_mul(sineo1, aynl));
+        vdouble step = v_div(f, fp);
+        eo1 = v_add(eo1, v_max(v_min(step, v_set1(0.95)), v_set1(-0.95)));
+    }
+    v_sincos(eo1, &sineo1, &coseo1);
+
+    /* Short-period periodics; (sinu, cosu) is a unit vector, so su is only ever rotated. */
+    vdouble ecose = v_fma(axnl, coseo1, v_mul(aynl, sineo1));
+    vdouble esine = v_sub(v_mul(axnl, sineo1), v_mul(aynl, coseo1));
+    vdouble el2 = v_fma(axnl, axnl, v_mul(aynl, aynl));
+    vdouble pl = v_mul(am, v_sub(one, el2));
+    vdouble rl = v_mul(am, v_sub(one, ecose));
+    vdouble inv_rl = v_div(one, rl);
+    vdouble rdotl = v_mul(v_mul(v_sqrt(am), esine), inv_rl);
+    vdouble rvdotl = v_mul(v_sqrt(pl), inv_rl);
+    vdouble betal = v_sqrt(v_sub(one, el2));
+    temp = v_div(esine, v_add(one, betal));
+    vdouble am_rl = v_mul(am, inv_rl);
+    vdouble sinu = v_mul(am_rl, v_sub(v_sub(sineo1, aynl), v_mul(axnl, temp)));
+    vdouble cosu = v_mul(am_rl, v_fma(aynl, temp, v_sub(coseo1, axnl)));
+    vdouble sin2u = v_mul(v_add(cosu, cosu), sinu);
+    vdouble cos2u = v_sub(one, v_mul(v_set1(2.0), v_mul(sinu, sinu)));
+    temp = v_div(one, pl);
+    vdouble temp1 = v_mul(v_mul(half, j2), temp);
+    vdouble temp2 = v_mul(temp1, temp);
+    vdouble x1mth2 = v_load(&s->x1mth2[k]), con41 = v_load(&s->con41[k]), cosio = v_load(&s->cosio[k]);
+    vdouble mrt = v_fma(v_mul(half, temp1), v_mul(x1mth2, cos2u),
+                        v_mul(rl, v_sub(one, v_mul(v_mul(one_half, temp2), v_mul(betal, con41)))));
+    vdouble dsu = v_mul(v_mul(v_set1(-0.25), temp2), v_mul(v_load(&s->x7thm1[k]), sin2u));
+    vdouble xnode = v_fma(v_mul(one_half, temp2), v_mul(cosio, sin2u), nodem);
+    vdouble xinc = v_fma(v_mul(one_half, temp2), v_mul(v_mul(cosio, v_load(&s->sinio[k])), cos2u), v_load(&s->inclo[k]));
+    vdouble nm_temp1 = v_div(v_mul(nm, temp1), xke);
+    vdouble mvt = v_sub(rdotl, v_mul(nm_temp1, v_mul(x1mth2, sin2u)));
+    vdouble rvdot = v_fma(nm_temp1, v_fma(x1mth2, cos2u, v_mul(one_half, con41)), rvdotl);
+
+    vdouble sin_d, cos_d, snod, cnod, sini, cosi;
+    v_sincos(dsu, &sin_d, &cos_d);
+    v_sincos(v_wrap_two_pi(xnode), &snod, &cnod);
+    v_sincos(xinc, &sini, &cosi);
+    vdouble sinsu = v_fma(sinu, cos_d, v_mul(cosu, sin_d));
+    vdouble cossu = v_sub(v_mul(cosu, cos_d), v_mul(sinu, sin_d));
+    vdouble xmx = v_sub(v_set1(0.0), v_mul(snod, cosi)), xmy = v_mul(cnod, cosi);
+    vdouble ux = v_fma(xmx, sinsu, v_mul(cnod, cossu));
+    vdouble uy = v_fma(xmy, sinsu, v_mul(snod, cossu));
+    vdouble uz = v_mul(sini, sinsu);
+    vdouble r = v_mul(mrt, v_set1(SGP4_RE));
+    v_store(&x[k], v_mul(r, ux));
+    v_store(&y[k], v_mul(r, uy));
+    v_store(&z[k], v_mul(r, uz));
+    if (vx) {
+        const vdouble vkmpersec = v_set1(SGP4_RE * SGP4_XKE / 60.0);
+        vdouble wx = v_sub(v_mul(xmx, cossu), v_mul(cnod, sinsu));
+        vdouble wy = v_sub(v_mul(xmy, cossu), v_mul(snod, sinsu));
+        vdouble wz = v_mul(sini, cossu);
+        v_store(&vx[k], v_mul(v_fma(mvt, ux, v_mul(rvdot, wx)), vkmpersec));
+        v_store(&vy[k], v_mul(v_fma(mvt, uy, v_mul(rvdot, wy)), vkmpersec));
+        v_store(&vz[k], v_mul(v_fma(mvt, uz, v_mul(rvdot, wz)), vkmpersec));
+    }
+}
+
+/*
+ * Two-body (or, with j2, J2 secular) motion for VLANES objects of the batch
+ * starting at k, with a fixed seven Newton iterations for Kepler's equation.
+ */
+static inline void propagate_two_body_lanes(const OrbitBatch *batch, int k, vdouble t, int j2,
+                                            double *x, double *y, double *z, double *vx, double *vy, double *vz) {
+    const vdouble one = v_set1(1.0);
+    vdouble dt = v_sub(t, v_load(&batch->epoch[k]));
+    vdouble e = v_load(&batch->ecc[k]);
+    vdouble M = v_wrap_two_pi(v_fma(v_load(&batch->mean_motion[k]), dt, v_load(&batch->mean_anomaly[k])));
+    vdouble E = M, sin_e, cos_e;
+    for (int it = 0; it < 7; ++it) {
+        v_sincos(E, &sin_e, &cos_e);
+        vdouble f = v_sub(v_sub(E, v_mul(e, sin_e)), M);
+        vdouble fp = v_sub(one, v_mul(e, cos_e));
+        E = v_sub(E, v_div(f, fp));
+    }
+    v_sincos(E, &sin_e, &cos_e);
+    vdouble px, py, pz, qx, qy, qz;
+    vdouble sin_raan, cos_raan, cos_inc, sin_inc;
+    if (j2) {
+        vdouble sin_argp, cos_argp;
+        v_sincos(v_wrap_two_pi(v_fma(v_load(&batch->raan_dot[k]), dt, v_load(&batch->raan[k]))), &sin_raan, &cos_raan);
+        v_sincos(v_wrap_two_pi(v_fma(v_load(&batch->argp_dot[k]), dt, v_load(&batch->argp[k]))), &sin_argp, &cos_argp);
+        cos_inc = v_load(&batch->cos_inc[k]);
+        sin_inc = v_load(&batch->sin_inc[k]);
+        vdouble sa_ci = v_mul(sin_argp, cos_inc), ca_ci = v_mul(cos_argp, cos_inc);
+        px = v_sub(v_mul(cos_raan, cos_argp), v_mul(sin_raan, sa_ci));
+        py = v_fma(cos_raan, sa_ci, v_mul(sin_raan, cos_argp));
+        pz = v_mul(sin_argp, sin_inc);
+        qx = v_sub(v_set1(0.0), v_fma(sin_raan, ca_ci, v_mul(cos_raan, sin_argp)));
+        qy = v_sub(v_mul(cos_raan, ca_ci), v_mul(sin_raan, sin_argp));
+        qz = v_mul(cos_argp, sin_inc);
+    } else {
+        px = v_load(&batch->px[k]); py = v_load(&batch->py[k]); pz = v_load(&batch->pz[k]);
+        qx = v_load(&batch->qx[k]); qy = v_load(&batch->qy[k]); qz = v_load(&batch->qz[k]);
+    }
+    vdouble xp = v_mul(v_load(&batch->a[k]), v_sub(cos_e, e));
+    vdouble yp = v_mul(v_load(&batch->b[k]), sin_e);
+    vdouble rx = v_fma(xp, px, v_mul(yp, qx));
+    vdouble ry = v_fma(xp, py, v_mul(yp, qy));
+    vdouble rz = v_fma(xp, pz, v_mul(yp, qz));
+    v_store(&x[k], rx);
+    v_store(&y[k], ry);
+    v_store(&z[k], rz);
+    if (vx) {
+        vdouble e_dot = v_div(v_load(&batch->mean_motion[k]), v_sub(one, v_mul(e, cos_e)));
+        vdouble vxp = v_sub(v_set1(0.0), v_mul(v_mul(v_load(&batch->a[k]), sin_e), e_dot));
+        vdouble vyp = v_mul(v_mul(v_load(&batch->b[k]), cos_e), e_dot);
+        vdouble wx = v_fma(vxp, px, v_mul(vyp, qx));
+        vdouble wy = v_fma(vxp, py, v_mul(vyp, qy));
+        vdouble wz = v_fma(vxp, pz, v_mul(vyp, qz));
+        if (j2) {
+            /* Frame spin, as in j2_state. */
+            vdouble argp_dot = v_load(&batch->argp_dot[k]);
+            vdouble sx = v_mul(v_mul(argp_dot, sin_inc), sin_raan);
+            vdouble sy = v_sub(v_set1(0.0), v_mul(v_mul(argp_dot, sin_inc), cos_raan));
+            vdouble sz = v_fma(argp_dot, cos_inc, v_load(&batch->raan_dot[k]));
+            wx = v_add(wx, v_sub(v_mul(sy, rz), v_mul(sz, ry)));
+            wy = v_add(wy, v_sub(v_mul(sz, rx), v_mul(sx, rz)));
+            wz = v_add(wz, v_sub(v_mul(sx, ry), v_mul(sy, rx)));
+        }
+        v_store(&vx[k], wx);
+        v_store(&vy[k], wy);
+        v_store(&vz[k], wz);
+    }
+}
+
+/*
+ * Positions of every orbit in the batch at sim_time, written to x/y/z (each
+ * batch->padded long): SGP4 for the near-Earth objects of an SGP4 batch,
+ * then the two-body or J2 model of propagate_state. Velocities are written
+ * to vx/vy/vz unless vx is NULL.
+ */
+static void propagate_batch(const OrbitBatch *batch, double sim_time, double *x, double *y, double *z,
+                            double *vx, double *vy, double *vz) {
+    const vdouble t = v_set1(sim_time);
+    for (int k = 0; k < batch->sgp4_count; k += VLANES) {
+        propagate_sgp4_lanes(&batch->sgp4, k, t, x, y, z, vx, vy, vz);
+    }
+    if (batch->j2) {
+        for (int k = batch->sgp4_count; k < batch->count; k += VLANES) {
+            propagate_two_body_lanes(batch, k, t, 1, x, y, z, vx, vy, vz);
+        }
+    } else {
+        for (int k = batch->sgp4_count; k < batch->count; k += VLANES) {
+            propagate_two_body_lanes(batch, k, t, 0, x, y, z, vx, vy, vz);
+        }
+    }
+}
+
+/* Group ids of one object under a request's exclusion policy; -1 where the policy ignores the group. */
+typedef struct {
+    int constellation, launch;
+} GroupKey;
+
+/* Keys of sats[idx[0..n-1]] under `policy`; NULL without memory. */
+static GroupKey *group_keys_build(const Satellite *sats, const int *idx, int n, ExclusionPolicy policy) {
+    GroupKey *keys = malloc(sizeof(GroupKey) * (n > 0 ? n : 1));
+    if (!keys) return NULL;
+    int by_constellation = policy == EXCLUDE_CONSTELLATION || policy == EXCLUDE_EITHER;
+    int by_launch = policy == EXCLUDE_LAUNCH || policy == EXCLUDE_EITHER;
+    for (int k = 0; k < n; ++k) {
+        const Satellite *sat = &sats[idx[k]];
+        keys[k] = (GroupKey){ by_constellation ? sat->constellation : -1, by_launch ? sat->launch : -1 };
+    }
+    return keys;
+}
+
+static inline int group_keys_excluded(const GroupKey *keys, int a, int b) {
+    return (keys[a].constellation >= 0 && keys[a].constellation == keys[b].constellation)
+        || (keys[a].launch >= 0 && keys[a].launch == keys[b].launch);
+}
+
+// --- Conjunction Screening Engine ---
+#define MIN_DIST_KM 0.01
+#define MAX_TOP_K 1000 /* largest top_k; the pair heap is searched linearly */
+
+typedef struct {
+    int i, j;          /* catalog indices, i < j; i == -1 marks an empty slot */
+    double min_dist;   /* km */
+    double min_time;   /* seconds from the start of the screening window */
+} Conjunction;
+
+/* Open-addressing map from a satellite pair to its closest approach so far. */
+typedef struct {
+    Conjunction *slots;
+    size_t capacity; /* always a power of two */
+    size_t count;
+} ConjunctionSet;
+
+/* Growable list of individual close approaches; a pair may appear once per approach. */
+typedef struct {
+    Conjunction *items;
+    size_t count;
+    size_t capacity;
+} ApproachList;
+
+/* Sweep progress of one screening, read by job status polls while it runs. */
+typedef struct {
+    long done;  /* time steps swept so far */
+    long total; /* 0 until the sweep starts */
+} ScreenProgress;
+
+/* Receives approaches as they are refined; emit may be called from several workers at once. */
+typedef struct {
+    int (*emit)(void *ctx, const Conjunction *c); /* returning 0 stops the screening */
+    void *ctx;
+} ApproachSink;
+
+typedef struct {
+    const Satellite *sats;
+    int count;
+    double start_time;   /* unix seconds */
+    long duration_sec;
+    long step_sec;
+    double threshold_km;
+    int refine;          /* solve for the exact TCA of every sampled approach */
+    const char *primary; /* per-satellite flags: only pairs with a primary are screened; NULL = all pairs */
+    ApproachList *approaches; /* refine mode: also receives every approach, not just each pair's closest */
+    ScreenProgress *progress; /* optional */
+    const ApproachSink *sink; /* refine mode: receives every approach as soon as it is refined, instead of `set` */
+    int top_k;           /* > 0: only the top_k closest pairs reach `set` */
+    PropagationModel model;
+    ExclusionPolicy exclude; /* which same-group pairs are never reported */
+} ScreenParams;
+
+static int conjunction_set_init(ConjunctionSet *set, size_t capacity) {
+    size_t cap = 64;
+    while (cap < capacity * 2) cap <<= 1;
+    set->slots = malloc(cap * sizeof(Conjunction));
+    if (!set->slots) return 0;
+    for (size_t k = 0; k < cap; k++) set->slots[k].i = -1;
+    set->capacity = cap;
+    set->count = 0;
+    return 1;
+}
+
+static void conjunction_set_free(ConjunctionSet *set) {
+    free(set->slots);
+    set->slots = NULL;
+    set->capacity = set->count = 0;
+}
+
+static size_t pair_hash(int i, int j) {
+    unsigned long long key = ((unsigned long long)(unsigned)i << 32) | (unsigned)j;
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return (size_t)key;
+}
+
+static Conjunction *conjunction_set_slot(Conjunction *slots, size_t capacity, int i, int j) {
+    size_t mask = capacity - 1;
+    size_t k = pair_hash(i, j) & mask;
+    while (slots[k].i != -1 && (slots[k].i != i || slots[k].j != j)) k = (k + 1) & mask;
+    return &slots[k];
+}
+
+static int conjunction_set_grow(ConjunctionSet *set) {
+    size_t cap = set->capacity * 2;
+    Conjunction *slots = malloc(cap * sizeof(Conjunction));
+    if (!slots) return 0;
+    for (size_t k = 0; k < cap; k++) slots[k].i = -1;
+    for (size_t k = 0; k < set->capacity; k++) {
+        if (set->slots[k].i == -1) continue;
+        *conjunction_set_slot(slots, cap, set->slots[k].i, set->slots[k].j) = set->slots[k];
+    }
+    free(set->slots);
+    set->slots = slots;
+    set->capacity = cap;
+    return 1;
+}
+
+/* Records an approach of pair (i, j), keeping only the closest one per pair. */
+static int conjunction_set_update(ConjunctionSet *set, int i, int j, double dist, double time) {
+    if (i > j) { int tmp = i; i = j; j = tmp; }
+    if ((set->count + 1) * 2 > set->capacity && !conjunction_set_grow(set)) return 0;
+    Conjunction *c = conjunction_set_slot(set->slots, set->capacity, i, j);
+    if (c->i == -1) {
+        c->i = i;
+        c->j = j;
+        c->min_dist = dist;
+        c->min_time = time;
+        set->count++;
+    } else if (dist < c->min_dist || (dist == c->min_dist && time < c->min_time)) {
+        c->min_dist = dist;
+        c->min_time = time;
+    }
+    return 1;
+}
+
+static int approach_list_push(ApproachList *list, int i, int j, double dist, double time) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 256;
+        Conjunction *items = realloc(list->items, sizeof(Conjunction) * capacity);
+        if (!items) return 0;
+        list->items = items;
+        list->capacity = capacity;
+    }
+    if (i > j) { int tmp = i; i = j; j = tmp; }
+    list->items[list->count++] = (Conjunction){ i, j, dist, time };
+    return 1;
+}
+
+static void approach_list_free(ApproachList *list) {
+    free(list->items);
+    list->items = NULL;
+    list->count = list->capacity = 0;
+}
+
+/* Bounded max-heap of the k closest pairs seen so far, one entry per pair. */
+typedef struct {
+    Conjunction *items; /* items[0] is the farthest pair kept */
+    int count;
+    int k;
+} PairHeap;
+
+static int pair_heap_init(PairHeap *heap, int k) {
+    heap->items = malloc(sizeof(Conjunction) * k);
+    heap->count = 0;
+    heap->k = k;
+    return heap->items != NULL;
+}
+
+static void pair_heap_free(PairHeap *heap) {
+    free(heap->items);
+    heap->items = NULL;
+    heap->count = 0;
+}
+
+/* Distance a pair must beat to get in: the k-th closest once full, otherwise infinity. */
+static double pair_heap_bound(const PairHeap *heap) {
+    return heap->count == heap->k ? heap->items[0].min_dist : INFINITY;
+}
+
+static void pair_heap_sift_down(PairHeap *heap, int at) {
+    Conjunction *h = heap->items;
+    while (1) {
+        int child = 2 * at + 1;
+        if (child >= heap->count) return;
+        if (child + 1 < heap->count && h[child + 1].min_dist > h[child].min_dist) child++;
+        if (h[child].min_dist <= h[at].min_dist) return;
+        Conjunction tmp = h[at]; h[at] = h[child]; h[child] = tmp;
+        at = child;
+    }
+}
+
+static void pair_heap_push(PairHeap *heap, int i, int j, double dist, double time) {
+    if (dist >= pair_heap_bound(heap)) return;
+    if (i > j) { int tmp = i; i = j; j = tmp; }
+    Conjunction *h = heap->items;
+    for (int at = 0; at < heap->count; ++at) {
+        if (h[at].i != i || h[at].j != j) continue;
+        if (dist < h[at].min_dist) {
+            h[at].min_dist = dist;
+            h[at].min_time = time;
+            pair_heap_sift_down(heap, at);
+        }
+        return;
+    }
+    if (heap->count == heap->k) {
+        h[0] = (Conjunction){ i, j, dist, time };
+        pair_heap_sift_down(heap, 0);
+        return;
+    }
+    int at = heap->count++;
+    h[at] = (Conjunction){ i, j, dist, time };
+    while (at > 0 && h[(at - 1) / 2].min_dist < h[at].min_dist) {
+        Conjunction tmp = h[at]; h[at] = h[(at - 1) / 2]; h[(at - 1) / 2] = tmp;
+        at = (at - 1) / 2;
+    }
+}
+
+static int compare_conjunction_distances(const void *a, const void *b) {
+    double da = ((const Conjunction *)a)->min_dist, db = ((const Conjunction *)b)->min_dist;
+    return (da > db) - (da < db);
+}
+
+static int compare_conjunction_pairs(const void *a, const void *b) {
+    const Conjunction *ca = a, *cb = b;
+    if (ca->i != cb->i) return ca->i < cb->i ? -1 : 1;
+    if (ca->j != cb->j) return ca->j < cb->j ? -1 : 1;
+    return 0;
+}
+
+/* Compacts the set in place into an array sorted by (i, j); the set must not be updated afterwards. */
+static Conjunction *conjunction_set_sorted(ConjunctionSet *set, size_t *count) {
+    size_t n = 0;
+    for (size_t k = 0; k < set->capacity; k++) {
+        if (set->slots[k].i != -1) set->slots[n++] = set->slots[k];
+    }
+    qsort(set->slots, n, sizeof(Conjunction), compare_conjunction_pairs);
+    *count = n;
+    return set->slots;
+}
+
+/*
+ * Classic conjunction sieve: cheap pair rejections from the mean elements
+ * alone, run before any propagation. Stages, in order:
+ *   apsis      - perigee/apogee shells further apart than the threshold
+ *   orbit path - near both mutual nodes, the radii the two orbits can have
+ *                while each is within the threshold of the other's plane
+ *                never come within the threshold
+ *   time       - the two objects are never inside their node windows at the
+ *                same time during the screening window
+ * Every stage is conservative for two-body motion. SGP4 and J2 objects
+ * precess, so for them only the apsis stage runs; SGP4 shells are also
+ * bounded over the window, since drag shrinks them.
+ */
+typedef struct {
+    double rp, ra;     /* perigee / apogee radius, km */
+    double p;          /* semi-latus rectum, km */
+    double h[3];       /* unit orbit normal */
+    double node[3];    /* unit vector to the ascending node */
+    double n;          /* mean motion, rad/s */
+    int secular;       /* SGP4 or J2 object: plane and phase drift, so only the apsis stage applies */
+} SieveOrbit;
+
+typedef struct {
+    long long pairs;
+    long long apsis_rejected;
+    long long orbit_path_rejected;
+    long long time_rejected;
+    long long passed;
+    long long skipped; /* not examined because both objects were already retained */
+    long long excluded; /* left out by the request's exclusion policy */
+} SieveStats;
+
+static void sieve_orbit_init(const Satellite *sat, SieveOrbit *o, double t0, double t1, PropagationModel model) {
+    double e = sat->eccentricity;
+    /* J2 objects move on the ellipse of the Brouwer mean motion, not the Kozai one of the TLE. */
+    double a = model == MODEL_J2 ? sat->orbit.a_j2 : sat->semi_major_axis;
+    o->rp = a * (1.0 - e);
+    o->ra = a * (1.0 + e);
+    o->secular = model == MODEL_J2 || (model == MODEL_SGP4 && sat->sgp4.active);
+    if (model == MODEL_SGP4 && sat->sgp4.active) {
+        sgp4_radius_range(&sat->sgp4, (t0 - sat->epoch_time) / 60.0, (t1 - sat->epoch_time) / 60.0, &o->rp, &o->ra);
+    }
+    o->p = a * (1.0 - e * e);
+    for (int k = 0; k < 3; ++k) o->h[k] = sat->orbit.w[k];
+    o->node[0] = cos(sat->raan);
+    o->node[1] = sin(sat->raan);
+    o->node[2] = 0.0;
+    o->n = sat->orbit.n;
+}
+
+static double wrap_two_pi(double a) {
+    a = fmod(a, 2.0 * M_PI);
+    return a < 0 ? a + 2.0 * M_PI : a;
+}
+
+/* Radius range of the orbit over true anomalies [nu - half_width, nu + half_width]. */
+static void sieve_radius_range(const Satellite *sat, const SieveOrbit *o, double nu, double half_width,
+                               double *rmin, double *rmax) {
+    double e = sat->eccentricity;
+    double r1 = o->p / (1.0 + e * cos(nu - half_width));
+    double r2 = o->p / (1.0 + e * cos(nu + half_width));
+    *rmin = fmin(r1, r2);
+    *rmax = fmax(r1, r2);
+    /* half_width <= pi/2, so the window touches perigee or apogee at most once. */
+    double start = wrap_two_pi(nu - half_width);
+    double end = start + 2.0 * half_width;
+    if (start == 0.0 || end >= 2.0 * M_PI) *rmin = o->rp;
+    if (start <= M_PI && end >= M_PI) *rmax = o->ra;
+}
+
+static double mean_anomaly_from_true(double nu, double e) {
+    double E = 2.0 * atan2(sqrt(1.0 - e) * sin(nu / 2.0), sqrt(1.0 + e) * cos(nu / 2.0));
+    return E - e * sin(E);
+}
+
+/*
+ * Do the passes of two objects through their true-anomaly windows ever overlap
+ * in [t0, t1]? Each window repeats once per revolution of its object.
+ */
+static int sieve_windows_overlap(const Satellite *s1, const SieveOrbit *o1, double nu1, double w1,
+                                 const Satellite *s2, const SieveOrbit *o2, double nu2, double w2,
+                                 double t0, double t1) {
+    const Satellite *sats[2] = { s1, s2 };
+    const SieveOrbit *orbits[2] = { o1, o2 };
+    double nus[2] = { nu1, nu2 }, widths[2] = { w1, w2 };
+    double start[2], length[2], period[2];
+    for (int k = 0; k < 2; ++k) {
+        double e = sats[k]->eccentricity;
+        double m_lo = mean_anomaly_from_true(nus[k] - widths[k], e);
+        double m_hi = mean_anomaly_from_true(nus[k] + widths[k], e);
+        double arc = wrap_two_pi(m_hi - m_lo);
+        period[k] = 2.0 * M_PI / orbits[k]->n;
+        length[k] = arc / orbits[k]->n;
+        /* First window entry at or before t0, so a window straddling t0 is kept. */
+        double entry = sats[k]->epoch_time + (m_lo - sats[k]->mean_anomaly) / orbits[k]->n;
+        start[k] = entry + floor((t0 - entry) / period[k]) * period[k];
+    }
+    while (start[0] <= t1 && start[1] <= t1) {
+        double end0 = start[0] + length[0], end1 = start[1] + length[1];
+        if (start[0] <= end1 && start[1] <= end0 && end0 >= t0 && end1 >= t0) return 1;
+        if (end0 < end1) start[0] += period[0];
+        else start[1] += period[1];
+    }
+    return 0;
+}
+
+/* Runs the orbit path and time stages on a pair whose apsis shells overlap. */
+static int sieve_pair(const Satellite *s1, const SieveOrbit *o1, const Satellite *s2, const SieveOrbit *o2,
+                      double threshold_km, double t0, double t1, SieveStats *stats) {
+    stats->pairs++;
+    /* Small relative pad so rounding never rejects a pair that sits exactly on the threshold. */
+    double d = threshold_km * (1.0 + 1e-9) + 1e-6;
+    if (fmax(o1->rp, o2->rp) - fmin(o1->ra, o2->ra) > d) {
+        stats->apsis_rejected++;
+        return 0;
+    }
+    if (o1->secular || o2->secular) { stats->passed++; return 1; }
+    double c[3] = {
+        o1->h[1] * o2->h[2] - o1->h[2] * o2->h[1],
+        o1->h[2] * o2->h[0] - o1->h[0] * o2->h[2],
+        o1->h[0] * o2->h[1] - o1->h[1] * o2->h[0],
+    };
+    double sin_rel = sqrt(c[0]*c[0] + c[1]*c[1] + c[2]*c[2]);
+    /* Near-coplanar orbits or huge thresholds: the node geometry tells us nothing. */
+    if (d >= o1->rp * sin_rel || d >= o2->rp * sin_rel) { stats->passed++; return 1; }
+    double w1 = asin(d / (o1->rp * sin_rel));
+    double w2 = asin(d / (o2->rp * sin_rel));
+    if (w1 + w2 > M_PI / 2.0) { stats->passed++; return 1; }
+
+    const Satellite *sats[2] = { s1, s2 };
+    const SieveOrbit *orbits[2] = { o1, o2 };
+    double nu[2];
+    for (int k = 0; k < 2; ++k) {
+        const SieveOrbit *o = orbits[k];
+        double along[3] = {
+            o->h[1] * o->node[2] - o->h[2] * o->node[1],
+            o->h[2] * o->node[0] - o->h[0] * o->node[2],
+            o->h[0] * o->node[1] - o->h[1] * o->node[0],
+        };
+        double u = atan2(along[0]*c[0] + along[1]*c[1] + along[2]*c[2],
+                         o->node[0]*c[0] + o->node[1]*c[1] + o->node[2]*c[2]);
+        nu[k] = u - sats[k]->arg_perigee;
+    }
+    int path_open = 0, time_open = 0;
+    for (int m = 0; m < 2 && !time_open; ++m) {
+        double shift = m * M_PI;
+        double r1min, r1max, r2min, r2max;
+        sieve_radius_range(s1, o1, nu[0] + shift, w1, &r1min, &r1max);
+        sieve_radius_range(s2, o2, nu[1] + shift, w2, &r2min, &r2max);
+        if (fmax(r1min, r2min) - fmin(r1max, r2max) > d) continue;
+        path_open = 1;
+        time_open = sieve_windows_overlap(s1, o1, nu[0] + shift, w1, s2, o2, nu[1] + shift, w2, t0, t1);
+    }
+    if (!path_open) { stats->orbit_path_rejected++; return 0; }
+    if (!time_open) { stats->time_rejected++; return 0; }
+    stats->passed++;
+    return 1;
+}
+
+typedef struct {
+    double rp;
+    int k;
+} PerigeeKey;
+
+static int compare_by_perigee(const void *a, const void *b) {
+    double ra = ((const PerigeeKey *)a)->rp, rb = ((const PerigeeKey *)b)->rp;
+    return (ra > rb) - (ra < rb);
+}
+
+#define SIEVE_ROWS_PER_TILE 64
+
+typedef struct {
+    const Satellite *sats;
+    const int *idx;
+    int n;
+    double threshold_km, t0, t1;
+    const char *primary;    /* indexed like sats; NULL = all pairs */
+    const GroupKey *groups; /* indexed like idx */
+    const SieveOrbit *orbits;
+    const PerigeeKey *order;
+    TileScheduler sched;
+    char *retain;           /* n flags per worker */
+    SieveStats *stats;      /* one per worker */
+    long long *overlapping; /* one per worker */
+} SieveJob;
+
+/* Walks tiles of rows of the perigee-sorted pair triangle. */
+static int sieve_worker(void *ctx, int worker) {
+    SieveJob *job = ctx;
+    char *retain = job->retain + (size_t)worker * job->n;
+    SieveStats *stats = &job->stats[worker];
+    double d = job->threshold_km * (1.0 + 1e-9) + 1e-6;
+    long tile = tile_scheduler_next(&job->sched, worker);
+    if (tile < 0) return 0;
+    int a_end = (int)((tile + 1) * SIEVE_ROWS_PER_TILE);
+    if (a_end > job->n) a_end = job->n;
+    for (int a = (int)(tile * SIEVE_ROWS_PER_TILE); a < a_end; ++a) {
+        int ka = job->order[a].k;
+        for (int b = a + 1; b < job->n && job->order[b].rp - job->orbits[ka].ra <= d; ++b) {
+            int kb = job->order[b].k;
+            if (job->primary && !job->primary[job->idx[ka]] && !job->primary[job->idx[kb]]) continue;
+            job->overlapping[worker]++;
+            if (group_keys_excluded(job->groups, ka, kb)) { stats->pairs++; stats->excluded++; continue; }
+            if (retain[ka] && retain[kb]) { stats->pairs++; stats->skipped++; continue; }
+            if (sieve_pair(&job->sats[job->idx[ka]], &job->orbits[ka], &job->sats[job->idx[kb]], &job->orbits[kb],
+                           job->threshold_km, job->t0, job->t1, stats)) {
+                retain[ka] = retain[kb] = 1;
+            }
+        }
+    }
+    return 1;
+}
+
+/*
+ * Sieves every pair of the n objects in `idx` and sets retain[k] for each one
+ * that survives with at least one partner. Pairs are walked in perigee order,
+ * so pairs whose shells cannot overlap are counted in bulk, never visited.
+ * With `primary`, pairs of two non-primary objects are ignored; pairs that
+ * `groups` (indexed like idx) excludes are counted but never retain.
+ */
+static int sieve_catalog(const Satellite *sats, const int *idx, int n, const char *primary, const GroupKey *groups,
+                         PropagationModel model, double threshold_km, double t0, double t1, char *retain,
+                         SieveStats *stats) {
+    int workers = worker_pool_width(&SCREEN_POOL);
+    SieveOrbit *orbits = malloc(sizeof(SieveOrbit) * (n > 0 ? n : 1));
+    PerigeeKey *order = malloc(sizeof(PerigeeKey) * (n > 0 ? n : 1));
+    SieveJob job = {
+        .sats = sats, .idx = idx, .n = n, .threshold_km = threshold_km, .t0 = t0, .t1 = t1,
+        .primary = primary, .groups = groups, .orbits = orbits, .order = order,
+        .retain = calloc((size_t)workers * (n > 0 ? n : 1), 1),
+        .stats = calloc(workers, sizeof(SieveStats)),
+        .overlapping = calloc(workers, sizeof(long long)),
+    };
+    long tiles = (n + SIEVE_ROWS_PER_TILE - 1) / SIEVE_ROWS_PER_TILE;
+    int ok = orbits && order && job.retain && job.stats && job.overlapping
+          && tile_scheduler_init(&job.sched, workers, tiles);
+    if (ok) {
+        for (int k = 0; k < n; ++k) {
+            sieve_orbit_init(&sats[idx[k]], &orbits[k], t0, t1, model);
+            order[k] = (PerigeeKey){ orbits[k].rp, k };
+        }
+        qsort(order, n, sizeof(PerigeeKey), compare_by_perigee);
+        worker_pool_run(&SCREEN_POOL, sieve_worker, &job);
+        tile_scheduler_free(&job.sched);
+
+        long long overlapping = 0;
+        for (int k = 0; k < n; ++k) retain[k] = 0;
+        for (int w = 0; w < workers; ++w) {
+            const char *r = job.retain + (size_t)w * n;
+            for (int k = 0; k < n; ++k) retain[k] |= r[k];
+            stats->pairs += job.stats[w].pairs;
+            stats->apsis_rejected += job.stats[w].apsis_rejected;
+            stats->orbit_path_rejected += job.stats[w].orbit_path_rejected;
+            stats->time_rejected += job.stats[w].time_rejected;
+            stats->passed += job.stats[w].passed;
+            stats->skipped += job.stats[w].skipped;
+            stats->excluded += job.stats[w].excluded;
+            overlapping += job.overlapping[w];
+        }
+        long long screened = (long long)n * (n - 1) / 2;
+        if (primary) {
+            long long np = 0;
+            for (int k = 0; k < n; ++k) np += primary[idx[k]] != 0;
+            screened = np * (n - np) + np * (np - 1) / 2;
+        }
+        long long bulk = screened - overlapping;
+        stats->pairs += bulk;
+        stats->apsis_rejected += bulk;
+    }
+    free(orbits);
+    free(order);
+    free(job.retain);
+    free(job.stats);
+    free(job.overlapping);
+    return ok;
+}
+
+/*
+ * Uniform 3D grid hashed into buckets, rebuilt every time step. Entries are
+ * counting-sorted by bucket so each neighbour scan reads contiguous memory.
+ * Distinct cells may share a bucket; the narrow phase distance check filters them.
+ *
+ * With SCREEN_COARSE_FLOAT the entries hold float32 copies of the positions:
+ * 16 bytes instead of 32, so the scan reads half the memory. A coarse test
+ * widened by coord_error stands in for the exact one, and its survivors are
+ * confirmed against the double position tables.
+ *
+ * The coarse test is scalar, not a float32 SIMD kernel. There are at least
+ * twice as many buckets as objects, so an object's 27 neighbour buckets are
+ * short separate runs of a few entries each. That is too few to fill vector
+ * lanes, and gathering them into lanes would cost more than the tests. The
+ * position tables propagate_batch writes stay double as well. The
+ * confirmation and refinement read them, and SGP4 in float32 would be off
+ * by metres at LEO radii.
+ */
+#if SCREEN_COARSE_FLOAT
+typedef float GridCoord;
+#define GRID_COORD_EPSILON FLT_EPSILON
+#else
+typedef double GridCoord;
+#define GRID_COORD_EPSILON DBL_EPSILON
+#endif
+
+typedef struct {
+    GridCoord x, y, z;
+    int id;           /* index into the active table */
+} GridEntry;
+
+typedef struct {
+    double cell_size;
+    double coord_error;   /* bound on the error of a distance between two entries, km */
+    size_t bucket_mask;
+    int *bucket_start;    /* bucket_mask + 2 offsets into entries */
+    int *entry_bucket;    /* bucket of each active index */
+    long long *entry_cell; /* cell coordinates of each active index, 3 per entry */
+    GridEntry *entries;
+    int count;
+} SpatialGrid;
+
+static int spatial_grid_init(SpatialGrid *g, int capacity, double cell_size) {
+    size_t buckets = 64;
+    while (buckets < (size_t)capacity * 2) buckets <<= 1;
+    g->cell_size = cell_size;
+    g->bucket_mask = buckets - 1;
+    g->bucket_start = malloc(sizeof(int) * (buckets + 1));
+    g->entry_bucket = malloc(sizeof(int) * (capacity > 0 ? capacity : 1));
+    g->entry_cell = malloc(sizeof(long long) * 3 * (capacity > 0 ? capacity : 1));
+    g->entries = malloc(sizeof(GridEntry) * (capacity > 0 ? capacity : 1));
+    g->count = 0;
+    return g->bucket_start && g->entry_bucket && g->entry_cell && g->entries;
+}
+
+static void spatial_grid_free(SpatialGrid *g) {
+    free(g->bucket_start);
+    free(g->entry_bucket);
+    free(g->entry_cell);
+    free(g->entries);
+}
+
+static size_t grid_bucket(const SpatialGrid *g, long long cx, long long cy, long long cz) {
+    unsigned long long h = (unsigned long long)cx * 73856093ULL
+                         ^ (unsigned long long)cy * 19349663ULL
+                         ^ (unsigned long long)cz * 83492791ULL;
+    h ^= h >> 29;
+    return (size_t)h & g->bucket_mask;
+}
+
+/* Buckets n positions for the current time step. */
+static void spatial_grid_build(SpatialGrid *g, const double *x, const double *y, const double *z, int n) {
+    size_t buckets = g->bucket_mask + 1;
+    memset(g->bucket_start, 0, sizeof(int) * (buckets + 1));
+    for (int a = 0; a < n; ++a) {
+        long long *c = &g->entry_cell[3*a];
+        c[0] = (long long)floor(x[a] / g->cell_size);
+        c[1] = (long long)floor(y[a] / g->cell_size);
+        c[2] = (long long)floor(z[a] / g->cell_size);
+        g->entry_bucket[a] = (int)grid_bucket(g, c[0], c[1], c[2]);
+        g->bucket_start[g->entry_bucket[a] + 1]++;
+    }
+    for (size_t b = 0; b < buckets; ++b) g->bucket_start[b + 1] += g->bucket_start[b];
+    double extent = 0;
+    for (int a = 0; a < n; ++a) {
+        int slot = g->bucket_start[g->entry_bucket[a]]++;
+        g->entries[slot] = (GridEntry){ (GridCoord)x[a], (GridCoord)y[a], (GridCoord)z[a], a };
+        double m = fabs(x[a]) + fabs(y[a]) + fabs(z[a]);
+        if (m > extent) extent = m;
+    }
+    /* extent bounds every coordinate; rounding moves each by at most half an ulp of it, so 4 eps covers both ends in 3D. */
+    g->coord_error = 4.0 * GRID_COORD_EPSILON * extent;
+    /* The fill pass advanced every start to the next bucket's; shift them back. */
+    for (size_t b = buckets; b > 0; --b) g->bucket_start[b] = g->bucket_start[b - 1];
+    g->bucket_start[0] = 0;
+    g->count = n;
+}
+
+/* Collects the distinct buckets of the 27 cells around entry a; returns how many. */
+static int spatial_grid_neighbours(const SpatialGrid *g, int a, int out[27]) {
+    const long long *c = &g->entry_cell[3*a];
+    int n = 0;
+    for (int dx = -1; dx <= 1; ++dx)
+        for (int dy = -1; dy <= 1; ++dy)
+            for (int dz = -1; dz <= 1; ++dz) {
+                int b = (int)grid_bucket(g, c[0] + dx, c[1] + dy, c[2] + dz);
+                int seen = 0;
+                for (int k = 0; k < n; ++k) if (out[k] == b) { seen = 1; break; }
+                if (!seen) out[n++] = b;
+            }
+    return n;
+}
+
+/*
+ * Time of closest approach refinement. Each sampled time t_k owns the interval
+ * [t_k - step/2, t_k + step/2]; the closest approach inside it is the root of
+ * the range rate r_rel . v_rel, bracketed by a sign change from - to +.
+ */
+static double pair_range_rate(const Satellite *s1, const Satellite *s2, PropagationModel model, double sim_time,
+                              double *dist) {
+    double r1[3], v1[3], r2[3], v2[3];
+    propagate_state(s1, model, sim_time, r1, v1);
+    propagate_state(s2, model, sim_time, r2, v2);
+    double dr[3] = { r1[0] - r2[0], r1[1] - r2[1], r1[2] - r2[2] };
+    double dv[3] = { v1[0] - v2[0], v1[1] - v2[1], v1[2] - v2[2] };
+    *dist = sqrt(dr[0]*dr[0] + dr[1]*dr[1] + dr[2]*dr[2]);
+    return dr[0]*dv[0] + dr[1]*dv[1] + dr[2]*dv[2];
+}
+
+/*
+ * Closest approach of a pair within [lo, hi] (seconds from start_time).
+ * Returns 0 when the minimum sits on an interior interval edge, since the
+ * neighbouring sample's interval owns that approach.
+ */
+static int refine_tca(const ScreenParams *p, const Satellite *s1, const Satellite *s2,
+                      double lo, double hi, double *tca, double *miss) {
+    double d_lo, d_hi;
+    double f_lo = pair_range_rate(s1, s2, p->model, p->start_time + lo, &d_lo);
+    double f_hi = pair_range_rate(s1, s2, p->model, p->start_time + hi, &d_hi);
+    if (f_lo < 0 && f_hi > 0) {
+        /* Regula falsi with the Illinois tweak, falling back to bisection. */
+        double a = lo, b = hi, fa = f_lo, fb = f_hi, t = lo, d = d_lo;
+        int side = 0;
+        for (int it = 0; it < 60 && b - a > 1e-3; ++it) {
+            t = (a * fb - b * fa) / (fb - fa);
+            if (!(t > a && t < b)) t = 0.5 * (a + b);
+            double f = pair_range_rate(s1, s2, p->model, p->start_time + t, &d);
+            if (f == 0) break;
+            if (f < 0) {
+                a = t; fa = f;
+                if (side == -1) fb *= 0.5;
+                side = -1;
+            } else {
+                b = t; fb = f;
+                if (side == 1) fa *= 0.5;
+                side = 1;
+            }
+        }
+        *tca = t;
+        *miss = d;
+        return 1;
+    }
+    /* No interior minimum: only the ends of the screening window count. */
+    if (lo <= 0 && f_lo >= 0) { *tca = lo; *miss = d_lo; return 1; }
+    if (hi >= p->duration_sec && f_hi <= 0) { *tca = hi; *miss = d_hi; return 1; }
+    return 0;
+}
+
+/* Smallest |r + v tau| over tau in [-h, h]. */
+static double linear_min_distance(const double r[3], const double v[3], double h) {
+    double vv = v[0]*v[0] + v[1]*v[1] + v[2]*v[2];
+    double tau = vv > 0 ? -(r[0]*v[0] + r[1]*v[1] + r[2]*v[2]) / vv : 0.0;
+    if (tau < -h) tau = -h;
+    if (tau > h) tau = h;
+    double d[3] = { r[0] + v[0]*tau, r[1] + v[1]*tau, r[2] + v[2]*tau };
+    return sqrt(d[0]*d[0] + d[1]*d[1] + d[2]*d[2]);
+}
+
+/*
+ * Seconds after a sample during which a pair r apart, with relative velocity
+ * v, provably stays beyond `limit`: the larger of two lower bounds on the
+ * separation, the distance less `speed` (the peak closing speed) times the
+ * elapsed time, and the straight-line track less the most `accel` can bend it.
+ */
+static double approach_gap(const double r[3], const double v[3], double speed, double accel, double limit) {
+    double d = sqrt(r[0]*r[0] + r[1]*r[1] + r[2]*r[2]);
+    if (d <= limit) return 0.0;
+    double gap = (d - limit) / speed;
+    double rv = r[0]*v[0] + r[1]*v[1] + r[2]*v[2];
+    double vv = v[0]*v[0] + v[1]*v[1] + v[2]*v[2];
+    /* Receding, the track never gets closer than d; approaching, it closes at most |v| and never passes the perpendicular. */
+    double bent = sqrt(2.0 * (d - limit) / accel);
+    if (rv < 0) {
+        double perp2 = d * d - rv * rv / vv;
+        bent = (sqrt(vv + 2.0 * accel * (d - limit)) - sqrt(vv)) / accel;
+        if (perp2 > limit * limit) {
+            double past = sqrt(2.0 * (sqrt(perp2) - limit) / accel);
+            if (past > bent) bent = past;
+        }
+    }
+    return bent > gap ? bent : gap;
+}
+
+/* Per-worker sweep state: the position table, grid and event buffer of one thread. */
+typedef struct {
+    double *x, *y, *z;
+    double *vx, *vy, *vz; /* refine mode only */
+    SpatialGrid grid;
+    ConjunctionSet set;
+    PairHeap top;         /* top_k mode: takes the place of `set` */
+    ApproachList approaches;
+    long *wake;           /* adaptive mode: the next step at which each object is sampled */
+    int *due;             /* adaptive mode: the objects sampled at the current step, ascending */
+    OrbitBatch due_batch; /* adaptive mode: their orbits, packed for propagate_batch */
+    double *state;        /* adaptive mode: six batch->padded tables of their positions and velocities */
+    int ok;
+} SweepWorker;
+
+typedef struct {
+    const ScreenParams *p;
+    const int *active;
+    const GroupKey *groups;   /* indexed like active */
+    const OrbitBatch *batch;
+    const double *speed_max;  /* refine mode: perigee speed of each active object, km/s */
+    const double *accel_max;  /* refine mode: gravity at perigee of each active object, km/s^2 */
+    double fastest;           /* refine mode: the largest speed_max */
+    const int *rows;          /* adaptive mode: the primaries, ascending; NULL = grid sweep */
+    int n_rows;
+    double cell_size;
+    int n;
+    long steps;
+    long steps_per_tile;
+    TileScheduler sched;
+    SweepWorker *workers;
+    double *top_k_bound;      /* top_k mode: the smallest k-th distance any worker holds */
+    int failed;               /* a worker ran out of memory or the sink stopped; the rest stop too */
+} SweepJob;
+
+/* Distance a pair must come within to matter: the threshold, tightened in top_k mode. */
+static double sweep_limit(const SweepJob *job) {
+    double limit = job->p->threshold_km;
+    if (job->p->top_k) {
+        double bound;
+        __atomic_load(job->top_k_bound, &bound, __ATOMIC_RELAXED);
+        if (bound < limit) limit = bound;
+    }
+    return limit;
+}
+
+/* Records an approach in the worker's pair set, or in top_k mode its pair heap. */
+static int sweep_record(const SweepJob *job, SweepWorker *w, int i, int j, double dist, double time) {
+    if (!job->p->top_k) return conjunction_set_update(&w->set, i, j, dist, time);
+    if (dist <= MIN_DIST_KM) return 1;
+    pair_heap_push(&w->top, i, j, dist, time);
+    /* A full heap's k-th distance bounds the global k-th; share the tightest. */
+    double bound = pair_heap_bound(&w->top), shared;
+    __atomic_load(job->top_k_bound, &shared, __ATOMIC_RELAXED);
+    while (bound < shared
+           && !__atomic_compare_exchange(job->top_k_bound, &shared, &bound, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {}
+    return 1;
+}
+
+/*
+ * Refine mode: a pair near the sample at offset t becomes a candidate when
+ * straight-line relative motion, padded by the most that gravity can bend
+ * it over half a step, brings it inside `limit`; candidates get an exact TCA.
+ */
+static int sweep_refine_pair(const SweepJob *job, SweepWorker *w, int a, int b, double d2, long t, double limit) {
+    const ScreenParams *p = job->p;
+    double h = 0.5 * p->step_sec;
+    double reach = limit + (job->speed_max[a] + job->speed_max[b]) * h;
+    if (d2 >= reach * reach) return 1;
+    double r[3] = { w->x[a] - w->x[b], w->y[a] - w->y[b], w->z[a] - w->z[b] };
+    double v[3] = { w->vx[a] - w->vx[b], w->vy[a] - w->vy[b], w->vz[a] - w->vz[b] };
+    double bend = 0.5 * (job->accel_max[a] + job->accel_max[b]) * h * h;
+    if (linear_min_distance(r, v, h) > limit + bend) return 1;
+    const Satellite *s1 = &p->sats[job->active[a]], *s2 = &p->sats[job->active[b]];
+    if (group_keys_excluded(job->groups, a, b)) return 1;
+    double lo = t - h < 0 ? 0 : t - h;
+    double hi = t + h > p->duration_sec ? p->duration_sec : t + h;
+    double tca, miss;
+    if (!refine_tca(p, s1, s2, lo, hi, &tca, &miss) || miss >= p->threshold_km) return 1;
+    if (p->approaches && !approach_list_push(&w->approaches, job->active[a], job->active[b], miss, tca)) return 0;
+    if (p->sink) {
+        /* The sink owns the approach; keeping it in the pair set too would grow with the results. */
+        int i = job->active[a], j = job->active[b];
+        Conjunction c = { i < j ? i : j, i < j ? j : i, miss, tca };
+        return p->sink->emit(p->sink->ctx, &c);
+    }
+    return sweep_record(job, w, job->active[a], job->active[b], miss, tca);
+}
+
+/* Tests a pair of active objects d2 apart at offset t: refines it, or records it if it is under `limit`. */
+static int sweep_test_pair(const SweepJob *job, SweepWorker *w, int a, int b, double d2, long t, double limit) {
+    const ScreenParams *p = job->p;
+    if (p->refine) return sweep_refine_pair(job, w, a, b, d2, t, limit);
+    if (d2 >= limit * limit) return 1;
+    if (group_keys_excluded(job->groups, a, b)) return 1;
+    int i = job->active[a], j = job->active[b];
+    return sweep_record(job, w, i, j, sqrt(d2), (double)t);
+}
+
+/* Propagates the active objects to offset t and records every pair under the threshold. */
+static int sweep_step(const SweepJob *job, long t, SweepWorker *w) {
+    const ScreenParams *p = job->p;
+    const int *active = job->active;
+    int n = job->batch->count;
+    double limit = sweep_limit(job);
+    propagate_batch(job->batch, p->start_time + t, w->x, w->y, w->z,
+                    p->refine ? w->vx : NULL, w->vy, w->vz);
+    spatial_grid_build(&w->grid, w->x, w->y, w->z, n);
+    for (int a = 0; a < n; ++a) {
+        /* Primary mode: rows are primaries, and a primary-primary pair is kept by its lower row only. */
+        int a_primary = p->primary && p->primary[active[a]];
+        if (p->primary && !a_primary) continue;
+        const GridCoord pa[3] = { (GridCoord)w->x[a], (GridCoord)w->y[a], (GridCoord)w->z[a] };
+        /* Coarse cut: no partner further than this can pass the exact tests below. */
+        double reach = p->refine ? limit + (job->speed_max[a] + job->fastest) * 0.5 * p->step_sec : limit;
+        double coarse = (reach + w->grid.coord_error) * (1.0 + 4.0 * GRID_COORD_EPSILON);
+        const GridCoord coarse_sq = (GridCoord)(coarse * coarse);
+        int buckets[27];
+        int nb = spatial_grid_neighbours(&w->grid, a, buckets);
+        for (int k = 0; k < nb; ++k) {
+            const GridEntry *e = &w->grid.entries[w->grid.bucket_start[buckets[k]]];
+            const GridEntry *end = &w->grid.entries[w->grid.bucket_start[buckets[k] + 1]];
+            for (; e < end; ++e) {
+                GridCoord cx = pa[0] - e->x, cy = pa[1] - e->y, cz = pa[2] - e->z;
+                if (cx*cx + cy*cy + cz*cz >= coarse_sq) continue;
+                if (a_primary ? e->id == a || (e->id < a && p->primary[active[e->id]]) : e->id <= a) continue;
+                double dx = w->x[a] - w->x[e->id], dy = w->y[a] - w->y[e->id], dz = w->z[a] - w->z[e->id];
+                if (!sweep_test_pair(job, w, a, e->id, dx*dx + dy*dy + dz*dz, t, limit)) return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+/*
+ * Adaptive step for primary mode with few primaries. Pairs are tested
+ * directly, and each non-primary object is sampled only at steps where it
+ * could be near a primary: approach_gap of its last sample against every
+ * primary says how long it provably stays beyond `limit`, and the object is
+ * not propagated again until then (less half a step in refine mode, whose
+ * sample intervals reach that far back). Primaries are sampled at every step.
+ */
+static int sweep_step_adaptive(const SweepJob *job, long k, SweepWorker *w) {
+    const ScreenParams *p = job->p;
+    long t = k * p->step_sec;
+    double limit = sweep_limit(job);
+    double h = p->refine ? 0.5 * p->step_sec : 0.0;
+    int m = 0;
+    for (int a = 0; a < job->n; ++a) {
+        if (w->wake[a] <= k) w->due[m++] = a;
+    }
+    if (2 * m > job->n) {
+        propagate_batch(job->batch, p->start_time + t, w->x, w->y, w->z, w->vx, w->vy, w->vz);
+    } else {
+        /* Few are due: pack them so no vector lane is spent on the others. */
+        size_t padded = job->batch->padded;
+        double *sx = w->state, *sy = sx + padded, *sz = sy + padded;
+        double *svx = sz + padded, *svy = svx + padded, *svz = svy + padded;
+        orbit_batch_gather(&w->due_batch, job->batch, w->due, m);
+        propagate_batch(&w->due_batch, p->start_time + t, sx, sy, sz, svx, svy, svz);
+        for (int i = 0; i < m; ++i) {
+            int a = w->due[i];
+            w->x[a] = sx[i];
+            w->y[a] = sy[i];
+            w->z[a] = sz[i];
+            w->vx[a] = svx[i];
+            w->vy[a] = svy[i];
+            w->vz[a] = svz[i];
+        }
+    }
+    for (int r = 0; r < job->n_rows; ++r) {
+        int a = job->rows[r];
+        for (int q = r + 1; q < job->n_rows; ++q) {
+            int b = job->rows[q];
+            double dx = w->x[a] - w->x[b], dy = w->y[a] - w->y[b], dz = w->z[a] - w->z[b];
+            if (!sweep_test_pair(job, w, a, b, dx*dx + dy*dy + dz*dz, t, limit)) return 0;
+        }
+    }
+    for (int i = 0; i < m; ++i) {
+        int b = w->due[i];
+        if (p->primary[job->active[b]]) continue;
+        double gap = INFINITY; /* seconds until b could be within limit of a primary */
+        for (int q = 0; q < job->n_rows; ++q) {
+            int a = job->rows[q];
+            double r[3] = { w->x[a] - w->x[b], w->y[a] - w->y[b], w->z[a] - w->z[b] };
+            double v[3] = { w->vx[a] - w->vx[b], w->vy[a] - w->vy[b], w->vz[a] - w->vz[b] };
+            if (!sweep_test_pair(job, w, a, b, r[0]*r[0] + r[1]*r[1] + r[2]*r[2], t, limit)) return 0;
+            double pair_gap = approach_gap(r, v, job->speed_max[a] + job->speed_max[b],
+                                           job->accel_max[a] + job->accel_max[b], limit);
+            if (pair_gap < gap) gap = pair_gap;
+        }
+        long skip = gap > h ? (long)((gap - h) / p->step_sec) : 0;
+        w->wake[b] = k + 1 + (skip < job->steps ? skip : job->steps);
+    }
+    return 1;
+}
+
+static int sweep_worker(void *ctx, int worker) {
+    SweepJob *job = ctx;
+    SweepWorker *w = &job->workers[worker];
+    long tile = __atomic_load_n(&job->failed, __ATOMIC_RELAXED) ? -1 : tile_scheduler_next(&job->sched, worker);
+    if (tile < 0) return 0;
+    long first = tile * job->steps_per_tile;
+    long last = first + job->steps_per_tile;
+    if (last > job->steps) last = job->steps;
+    if (job->rows) {
+        /* Tiles are not contiguous in time, so every object is sampled at a tile's first step. */
+        for (int a = 0; a < job->n; ++a) w->wake[a] = first;
+        for (long k = first; w->ok && k < last; ++k) w->ok = sweep_step_adaptive(job, k, w);
+    } else {
+        for (long k = first; w->ok && k < last; ++k) w->ok = sweep_step(job, k * job->p->step_sec, w);
+    }
+    if (job->p->progress) __atomic_fetch_add(&job->p->progress->done, last - first, __ATOMIC_RELAXED);
+    if (!w->ok) __atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+    return 1;
+}
+
+/* Bounds on the speed (km/s) and acceleration (km/s^2) of `sat` under `model` over [t0, t1]. */
+static void motion_bounds(const Satellite *sat, PropagationModel model, double t0, double t1, double *speed_max,
+                          double *accel_max) {
+    double rp = sat->semi_major_axis * (1.0 - sat->eccentricity);
+    *speed_max = sqrt(EARTH_MU * (1.0 + sat->eccentricity) / rp);
+    *accel_max = EARTH_MU / (rp * rp);
+    if (model == MODEL_SGP4 && sat->sgp4.active) {
+        /* Vis-viva over the window's radius bounds, with 2% for J2 and the osculating terms. */
+        double rmin, rmax;
+        sgp4_radius_range(&sat->sgp4, (t0 - sat->epoch_time) / 60.0, (t1 - sat->epoch_time) / 60.0, &rmin, &rmax);
+        *speed_max = 1.02 * sqrt(EARTH_MU * (2.0 / rmin - 1.0 / rmax));
+        *accel_max = 1.02 * EARTH_MU / (rmin * rmin);
+    } else if (model == MODEL_J2) {
+        /*
+         * Motion on the J2 ellipse at n_j2, which peaks at its perigee, plus
+         * that of the frame turning at `spin`: w x r, then the Coriolis,
+         * centripetal and frame-drift terms of the acceleration.
+         */
+        const PreparedOrbit *o = &sat->orbit;
+        double e = sat->eccentricity, sin_inc = sin(sat->inclination);
+        double rp_j2 = o->a_j2 * (1.0 - e), ra_j2 = o->a_j2 * (1.0 + e);
+        double v_perigee = o->n_j2 * o->a_j2 * sqrt((1.0 + e) / (1.0 - e));
+        double spin_z = o->argp_dot * o->w[2] + o->raan_dot;
+        double spin = sqrt(o->argp_dot * o->argp_dot * sin_inc * sin_inc + spin_z * spin_z);
+        *speed_max = v_perigee + spin * ra_j2;
+        *accel_max = o->n_j2 * o->n_j2 * o->a_j2 * o->a_j2 * o->a_j2 / (rp_j2 * rp_j2) + 2.0 * spin * v_perigee
+                   + (spin * spin + fabs(o->raan_dot * o->argp_dot) * sin_inc) * ra_j2;
+    }
+}
+
+/*
+ * Time-major screening: every valid satellite is propagated exactly once per
+ * time step into a shared position table, and the pair loop only reads from it.
+ * Pairs that come within the threshold are tracked in `set`. The sieve runs
+ * first so objects without a surviving partner are never propagated, and a
+ * spatial grid with cells as wide as the threshold limits the pair tests of
+ * each step to objects in the same or neighbouring cells.
+ *
+ * Retained objects are packed into an OrbitBatch so each step's table is
+ * filled by the SIMD batch propagator under p->model.
+ *
+ * With p->refine the samples only seed candidates: grid cells grow by the
+ * distance the fastest pair can close in half a step, and every candidate is
+ * refined to its exact time of closest approach.
+ *
+ * Time steps are cut into tiles and spread over SCREEN_POOL with work
+ * stealing; every worker keeps its own table, grid and event buffer, and the
+ * buffers are merged into `set` at the end.
+ *
+ * With p->top_k each worker keeps only its own top_k pairs in a bounded heap,
+ * and the tightest k-th distance of any full heap replaces the threshold in
+ * the sweep's pair tests. A pair in the global top_k is in the top_k of the
+ * worker that saw its closest approach, so merging the heaps is exact.
+ *
+ * With at most SCREEN_ADAPTIVE_ROWS primaries the grid is replaced by
+ * sweep_step_adaptive, which samples each other object only when the
+ * separation and peak speeds of its last sample allow it near a primary.
+ */
+static int screen_catalog(const ScreenParams *p, ConjunctionSet *set, SieveStats *stats) {
+    /*
+     * Refinement needs at most one approach per sample interval, and the grid
+     * cell grows with the step, so coarse requests are seeded at REFINE_STEP_SEC.
+     */
+    ScreenParams seeded;
+    if (p->refine && p->step_sec > REFINE_STEP_SEC) {
+        seeded = *p;
+        seeded.step_sec = REFINE_STEP_SEC;
+        p = &seeded;
+    }
+    int *active = malloc(sizeof(int) * (p->count > 0 ? p->count : 1));
+    char *retain = malloc(p->count > 0 ? p->count : 1);
+    if (!active || !retain) { free(active); free(retain); return 0; }
+    int n = 0;
+    double t0 = p->start_time, t1 = p->start_time + p->duration_sec;
+    int sgp4 = p->model == MODEL_SGP4;
+    for (int i = 0; i < p->count; ++i) {
+        /* Objects SGP4 has decayed by either end of the window are not screened. */
+        if (p->sats[i].valid && (!sgp4 || !p->sats[i].sgp4.active || sgp4_in_orbit(&p->sats[i], t0, t1))) active[n++] = i;
+    }
+    GroupKey *groups = group_keys_build(p->sats, active, n, p->exclude);
+    if (!groups || !sieve_catalog(p->sats, active, n, p->primary, groups, p->model, p->threshold_km, p->start_time,
+                                  p->start_time + p->duration_sec, retain, stats)) {
+        free(active); free(retain); free(groups);
+        return 0;
+    }
+    if (!SCREEN_SIEVE) memset(retain, 1, n);
+    int kept = 0;
+    for (int a = 0; a < n; ++a) {
+        if (retain[a]) { groups[kept] = groups[a]; active[kept++] = active[a]; }
+    }
+    n = kept;
+    free(retain);
+    /* SGP4 objects go first, the layout orbit_batch_build wants. */
+    int *packed = malloc(sizeof(int) * (n > 0 ? n : 1));
+    GroupKey *packed_groups = malloc(sizeof(GroupKey) * (n > 0 ? n : 1));
+    if (!packed || !packed_groups) { free(packed); free(packed_groups); free(groups); free(active); return 0; }
+    int n_sgp4 = 0;
+    for (int a = 0; a < n; ++a) {
+        if (sgp4 && p->sats[active[a]].sgp4.active) { packed_groups[n_sgp4] = groups[a]; packed[n_sgp4++] = active[a]; }
+    }
+    for (int a = 0, k = n_sgp4; a < n; ++a) {
+        if (!sgp4 || !p->sats[active[a]].sgp4.active) { packed_groups[k] = groups[a]; packed[k++] = active[a]; }
+    }
+    free(active);
+    free(groups);
+    active = packed;
+    groups = packed_groups;
+    OrbitBatch batch;
+    if (!orbit_batch_build(&batch, p->sats, active, n, n_sgp4, p->model)) { free(groups); free(active); return 0; }
+    double *speed_max = malloc(sizeof(double) * (n > 0 ? n : 1));
+    double *accel_max = malloc(sizeof(double) * (n > 0 ? n : 1));
+    if (!speed_max || !accel_max) {
+        free(speed_max); free(accel_max); orbit_batch_free(&batch); free(groups); free(active);
+        return 0;
+    }
+    double fastest = 0;
+    for (int a = 0; a < n; ++a) {
+        const Satellite *sat = &p->sats[active[a]];
+        motion_bounds(sat, p->model, t0, t1, &speed_max[a], &accel_max[a]);
+        if (speed_max[a] > fastest) fastest = speed_max[a];
+    }
+
+    /* A few primaries: the adaptive sweep tests their pairs directly and skips the grid. */
+    int *rows = NULL, n_rows = 0;
+    if (p->primary) {
+        for (int a = 0; a < n; ++a) n_rows += p->primary[active[a]] != 0;
+        if (n_rows <= SCREEN_ADAPTIVE_ROWS) {
+            rows = malloc(sizeof(int) * (n_rows > 0 ? n_rows : 1));
+            if (!rows) {
+                free(speed_max); free(accel_max); orbit_batch_free(&batch); free(groups); free(active);
+                return 0;
+            }
+            for (int a = 0, r = 0; a < n; ++a) {
+                if (p->primary[active[a]]) rows[r++] = a;
+            }
+        }
+    }
+
+    int workers = worker_pool_width(&SCREEN_POOL);
+    double top_k_bound = INFINITY;
+    SweepJob job = {
+        .p = p,
+        .active = active,
+        .groups = groups,
+        .batch = &batch,
+        .speed_max = speed_max,
+        .accel_max = accel_max,
+        .fastest = fastest,
+        .rows = rows,
+        .n_rows = n_rows,
+        .cell_size = p->threshold_km > 0 ? p->threshold_km : 1.0,
+        .n = n,
+        .steps = p->duration_sec / p->step_sec + 1,
+        .workers = calloc(workers, sizeof(SweepWorker)),
+        .top_k_bound = &top_k_bound,
+    };
+    if (p->refine) job.cell_size += fastest * p->step_sec;
+    job.steps_per_tile = job.steps / (workers * 16L);
+    if (job.steps_per_tile > SCREEN_TILE_STEPS) job.steps_per_tile = SCREEN_TILE_STEPS;
+    if (job.steps_per_tile < 1) job.steps_per_tile = 1;
+    int ok = job.workers != NULL;
+    for (int w = 0; ok && w < workers; ++w) {
+        SweepWorker *sw = &job.workers[w];
+        sw->x = malloc(sizeof(double) * batch.padded);
+        sw->y = malloc(sizeof(double) * batch.padded);
+        sw->z = malloc(sizeof(double) * batch.padded);
+        sw->ok = conjunction_set_init(&sw->set, 256) && sw->x && sw->y && sw->z;
+        if (sw->ok && rows) {
+            sw->wake = malloc(sizeof(long) * (n > 0 ? n : 1));
+            sw->due = malloc(sizeof(int) * (n > 0 ? n : 1));
+            sw->state = malloc(sizeof(double) * 6 * batch.padded);
+            sw->ok = sw->wake && sw->due && sw->state && orbit_batch_alloc(&sw->due_batch, n, n_sgp4, p->model);
+        } else if (sw->ok) {
+            sw->ok = spatial_grid_init(&sw->grid, n, job.cell_size);
+        }
+        if (sw->ok && (p->refine || rows)) {
+            sw->vx = malloc(sizeof(double) * batch.padded);
+            sw->vy = malloc(sizeof(double) * batch.padded);
+            sw->vz = malloc(sizeof(double) * batch.padded);
+            sw->ok = sw->vx && sw->vy && sw->vz;
+        }
+        if (sw->ok && p->top_k) sw->ok = pair_heap_init(&sw->top, p->top_k);
+        ok = sw->ok;
+    }
+    long tiles = (job.steps + job.steps_per_tile - 1) / job.steps_per_tile;
+    if (ok && tile_scheduler_init(&job.sched, workers, tiles)) {
+        if (p->progress) __atomic_store_n(&p->progress->total, job.steps, __ATOMIC_RELAXED);
+        worker_pool_run(&SCREEN_POOL, sweep_worker, &job);
+        tile_scheduler_free(&job.sched);
+    } else {
+        ok = 0;
+    }
+    PairHeap top = {0};
+    if (ok && p->top_k) ok = pair_heap_init(&top, p->top_k);
+    for (int w = 0; job.workers && w < workers; ++w) {
+        SweepWorker *sw = &job.workers[w];
+        ok = ok && sw->ok;
+        for (int k = 0; ok && k < sw->top.count; ++k) {
+            const Conjunction *c = &sw->top.items[k];
+            pair_heap_push(&top, c->i, c->j, c->min_dist, c->min_time);
+        }
+        pair_heap_free(&sw->top);
+        for (size_t k = 0; ok && k < sw->set.capacity; ++k) {
+            const Conjunction *c = &sw->set.slots[k];
+            if (c->i != -1) ok = conjunction_set_update(set, c->i, c->j, c->min_dist, c->min_time);
+        }
+        for (size_t k = 0; ok && p->approaches && k < sw->approaches.count; ++k) {
+            const Conjunction *c = &sw->approaches.items[k];
+            ok = approach_list_push(p->approaches, c->i, c->j, c->min_dist, c->min_time);
+        }
+        approach_list_free(&sw->approaches);
+        free(sw->x);
+        free(sw->y);
+        free(sw->z);
+        free(sw->vx);
+        free(sw->vy);
+        free(sw->vz);
+        free(sw->wake);
+        free(sw->due);
+        free(sw->state);
+        orbit_batch_free(&sw->due_batch);
+        spatial_grid_free(&sw->grid);
+        conjunction_set_free(&sw->set);
+    }
+    for (int k = 0; ok && k < top.count; ++k) {
+        ok = conjunction_set_update(set, top.items[k].i, top.items[k].j, top.items[k].min_dist, top.items[k].min_time);
+    }
+    pair_heap_free(&top);
+    free(job.workers);
+    free(rows);
+    free(speed_max);
+    free(accel_max);
+    orbit_batch_free(&batch);
+    free(groups);
+    free(active);
+    return ok;
+}
+
+// --- Conjunction Cache ---
+/*
+ * The whole catalog is screened once in the background, with TCA refinement,
+ * over CACHE_HORIZON_DAYS and up to CACHE_THRESHOLD_KM. Every approach is kept
+ * in a table sorted by TCA, so a /predict request that fits inside the cached
+ * window and ceiling is answered by a binary search and a scan.
+ *
+ * Every CACHE_ROLL_SEC the window slides forward: approaches now in the past
+ * are dropped and only the newly exposed tail is screened, so a fresh
+ * horizon costs the tail rather than a full rebuild. A catalog update drops
+ * the approaches of the objects it changed and screens just those objects
+ * against the catalog.
+ *
+ * A finished build, roll or rescreen replaces the table as a whole. Readers hold a
+ * reference while they scan, so a streamed response can read the table
+ * without keeping the lock over network writes.
+ *
+ * Approaches name objects by catalog index. Updates keep indices and only
+ * append, so a table also serves requests holding a later catalog, but not
+ * one holding an earlier catalog than it was screened against.
+ */
+typedef struct {
+    int refs;               /* guarded by CONJ_CACHE.lock */
+    unsigned long generation; /* of the catalog it was screened against */
+    double start_time;      /* unix seconds; approach times are offsets from here */
+    long horizon_sec;
+    double ceiling_km;
+    Conjunction *approaches; /* sorted by min_time */
+    size_t count;
+    SieveStats stats;       /* of the build */
+} ConjunctionTable;
+
+typedef struct {
+    pthread_mutex_t lock;
+    int building;            /* a build, roll or rescreen is running */
+    int pending;             /* a full build was asked for meanwhile */
+    ConjunctionTable *table; /* NULL until the first build finishes */
+} ConjunctionCache;
+
+static ConjunctionCache CONJ_CACHE = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static int compare_approach_times(const void *a, const void *b) {
+    double ta = ((const Conjunction *)a)->min_time, tb = ((const Conjunction *)b)->min_time;
+    return (ta > tb) - (ta < tb);
+}
+
+/* Drops a table reference. Caller holds CONJ_CACHE.lock. */
+static void conjunction_table_unref(ConjunctionTable *table) {
+    if (table && --table->refs == 0) {
+        free(table->approaches);
+        free(table);
+    }
+}
+
+/*
+ * Screens `catalog` over [start_time, start_time + duration_sec] for the
+ * cache, every approach into `list`; with `primary`, only pairs involving a
+ * flagged object.
+ */
+static int conjunction_cache_screen(const Catalog *catalog, double start_time, long duration_sec, const char *primary,
+                                    ApproachList *list, SieveStats *stats) {
+    ConjunctionSet set;
+    ScreenParams params = {
+        .sats = catalog->sats,
+        .count = catalog->count,
+        .start_time = start_time,
+        .duration_sec = duration_sec,
+        .step_sec = REFINE_STEP_SEC,
+        .threshold_km = CACHE_THRESHOLD_KM,
+        .refine = 1,
+        .primary = primary,
+        .approaches = list,
+    };
+    int ok = conjunction_set_init(&set, 1024) && screen_catalog(&params, &set, stats);
+    conjunction_set_free(&set);
+    return ok;
+}
+
+/* Index of the first approach at or after offset t. */
+static size_t conjunction_table_lower_bound(const ConjunctionTable *table, double t) {
+    size_t begin = 0, end = table->count;
+    while (begin < end) {
+        size_t mid = begin + (end - begin) / 2;
+        if (table->approaches[mid].min_time < t) begin = mid + 1;
+        else end = mid;
+    }
+    return begin;
+}
+
+/*
+ * Installs a finished table, or keeps the old one when the build failed.
+ * Returns 1, still marked building, when a full build was asked for meanwhile.
+ */
+static int conjunction_cache_install(ConjunctionTable *table) {
+    pthread_mutex_lock(&CONJ_CACHE.lock);
+    if (table) {
+        conjunction_table_unref(CONJ_CACHE.table);
+        CONJ_CACHE.table = table;
+    }
+    int again = CONJ_CACHE.pending;
+    CONJ_CACHE.pending = 0;
+    CONJ_CACHE.building = again;
+    pthread_mutex_unlock(&CONJ_CACHE.lock);
+    return again;
+}
+
+/* A full table for `catalog` over CACHE_HORIZON_DAYS from start_time; NULL when out of memory. */
+static ConjunctionTable *conjunction_table_build(const Catalog *catalog, double start_time) {
+    ApproachList list = {0};
+    SieveStats stats = {0};
+    long horizon_sec = CACHE_HORIZON_DAYS * 86400L;
+    int ok = conjunction_cache_screen(catalog, start_time, horizon_sec, NULL, &list, &stats);
+    ConjunctionTable *table = ok ? malloc(sizeof(ConjunctionTable)) : NULL;
+    if (!table) {
+        approach_list_free(&list);
+        return NULL;
+    }
+    qsort(list.items, list.count, sizeof(Conjunction), compare_approach_times);
+    *table = (ConjunctionTable){
+        .refs = 1,
+        .generation = catalog->generation,
+        .start_time = start_time,
+        .horizon_sec = horizon_sec,
+        .ceiling_km = CACHE_THRESHOLD_KM,
+        .approaches = list.items,
+        .count = list.count,
+        .stats = stats,
+    };
+    return table;
+}
 
-static User USERS_DB[MAX_USERS];
-static int USERS_COUNT = 0;
-pthread_mutex_t db_mutex = PTHREAD_MUTEX_INITIALIZER;
+static void *conjunction_cache_build(void *arg) {
+    (void)arg;
+    int again;
+    do {
+        time_t began = time(NULL);
+        Catalog *catalog = catalog_acquire();
+        ConjunctionTable *table = conjunction_table_build(catalog, (double)began);
+        catalog_release(catalog);
+        size_t count = table ? table->count : 0;
+        again = conjunction_cache_install(table);
+        if (table) {
+            printf("Conjunction cache: %zu approaches under %.1f km over %d days, built in %lds.\n",
+                   count, CACHE_THRESHOLD_KM, CACHE_HORIZON_DAYS, (long)(time(NULL) - began));
+        } else {
+            fprintf(stderr, "Conjunction cache build failed; /predict will screen on request.\n");
+        }
+    } while (again);
+    return NULL;
+}
 
-// --- Core Satellite Logic ---
-static double deg2rad(double deg) { return deg * M_PI / 180.0; }
-static double get_tle_val(const char *tle_line, int start, int len) {
-    char buf[32];
-    strncpy(buf, tle_line + start, len);
-    buf[len] = '\0';
-    return atof(buf);
+/* Starts a full build on a background thread. The caller has marked the cache building. */
+static void conjunction_cache_spawn(void) {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, conjunction_cache_build, NULL) != 0) {
+        pthread_mutex_lock(&CONJ_CACHE.lock);
+        CONJ_CACHE.building = 0;
+        pthread_mutex_unlock(&CONJ_CACHE.lock);
+        fprintf(stderr, "Could not start the conjunction cache build.\n");
+        return;
+    }
+    pthread_detach(thread);
 }
-static int get_tle_int(const char* tle_line, int start, int len) {
-    char buf[32];
-    strncpy(buf, tle_line + start, len);
-    buf[len] = '\0';
-    return atoi(buf);
+
+/* Rebuilds the cache on a background thread, after whatever is running now; call after the catalog changes. */
+static void conjunction_cache_refresh(void) {
+    pthread_mutex_lock(&CONJ_CACHE.lock);
+    int busy = CONJ_CACHE.building;
+    if (busy) CONJ_CACHE.pending = 1;
+    CONJ_CACHE.building = 1;
+    pthread_mutex_unlock(&CONJ_CACHE.lock);
+    if (!busy) conjunction_cache_spawn();
 }
 
-static int parse_tle_elements(Satellite *sat) {
-    char tle2[LINE_LEN];
-    strncpy(tle2, sat->tle2, LINE_LEN);
-    sat->inclination = deg2rad(get_tle_val(tle2, 8, 8));
-    sat->raan = deg2rad(get_tle_val(tle2, 17, 8));
-    char ecc_str[16] = "0.";
-    strncat(ecc_str, tle2 + 26, 7);
-    sat->eccentricity = atof(ecc_str);
-    sat->arg_perigee = deg2rad(get_tle_val(tle2, 34, 8));
-    sat->mean_anomaly = deg2rad(get_tle_val(tle2, 43, 8));
-    sat->mean_motion = get_tle_val(tle2, 52, 11);
-    if (sat->mean_motion <= 0) return 0;
-    double n_rad_per_sec = sat->mean_motion * 2.0 * M_PI / 86400.0;
-    double a_cubed = EARTH_MU / (n_rad_per_sec * n_rad_per_sec);
-    sat->semi_major_axis = cbrt(a_cubed);
-    sat->altitude = sat->semi_major_axis - EARTH_RADIUS;
-    if (sat->altitude < -0.5) return 0;
-    return 1;
+/*
+ * Returns a reference to the current table when a request on `catalog` for
+ * [start_time, start_time + duration_sec] under threshold_km fits in it, or
+ * NULL. *first is the first approach at or after start_time and *offset is
+ * start_time as a table offset. Release with conjunction_cache_release.
+ */
+static ConjunctionTable *conjunction_cache_acquire(const Catalog *catalog, double start_time, long duration_sec,
+                                                   double threshold_km, size_t *first, double *offset) {
+    pthread_mutex_lock(&CONJ_CACHE.lock);
+    ConjunctionTable *table = CONJ_CACHE.table;
+    double lo = table ? start_time - table->start_time : 0;
+    if (!table || table->generation > catalog->generation || lo < 0 || lo + duration_sec > table->horizon_sec
+        || threshold_km > table->ceiling_km) {
+        pthread_mutex_unlock(&CONJ_CACHE.lock);
+        return NULL;
+    }
+    table->refs++;
+    pthread_mutex_unlock(&CONJ_CACHE.lock);
+    *first = conjunction_table_lower_bound(table, lo);
+    *offset = lo;
+    return table;
 }
 
-static void trim_newline(char *s) {
-    size_t L = strlen(s);
-    while (L > 0 && (s[L-1] == '\n' || s[L-1] == '\r')) { s[--L] = '\0'; }
+static void conjunction_cache_release(ConjunctionTable *table) {
+    pthread_mutex_lock(&CONJ_CACHE.lock);
+    conjunction_table_unref(table);
+    pthread_mutex_unlock(&CONJ_CACHE.lock);
 }
 
-static int load_tle_file(const char *filename, Satellite sats[], int max_sats) {
-    FILE *f = fopen(filename, "r");
-    if (!f) return -1;
-    char line[LINE_LEN];
-    int count = 0;
-    while (count < max_sats) {
-        if (!fgets(line, LINE_LEN, f)) break;
-        trim_newline(line);
-        if (strlen(line) == 0) continue;
-        strncpy(sats[count].name, line, NAME_LEN-1);
-        sats[count].name[NAME_LEN-1] = '\0';
-        if (!fgets(sats[count].tle1, LINE_LEN, f)) break;
-        trim_newline(sats[count].tle1);
-        if (!fgets(sats[count].tle2, LINE_LEN, f)) break;
-        trim_newline(sats[count].tle2);
-
-        sats[count].norad_id = get_tle_int(sats[count].tle1, 2, 5);
-
-        char epoch_str[15];
-        char year_str[3];
-        strncpy(epoch_str, sats[count].tle1 + 18, 14);
-        epoch_str[14] = '\0';
-        strncpy(year_str, epoch_str, 2);
-        year_str[2] = '\0';
-        int epoch_year = atoi(year_str);
-        double epoch_day = atof(epoch_str + 2);
-        int full_year = (epoch_year < 57) ? (2000 + epoch_year) : (1900 + epoch_year);
-        struct tm t = {0};
-        t.tm_year = full_year - 1900;
-        t.tm_mday = 1;
-        time_t jan1 = timegm(&t);
-        sats[count].epoch_time = jan1 + (epoch_day - 1.0) * 86400.0;
-
-        if (parse_tle_elements(&sats[count])) {
-            sats[count].valid = 1;
-        } else {
-            sats[count].valid = 0;
-        }
-        count++;
+/*
+ * Fills `set` with each pair's closest cached approach under threshold_km in
+ * [start_time, start_time + duration_sec], times relative to start_time.
+ * Returns 1 on a hit, 0 when the request does not fit the cache and -1 when
+ * out of memory.
+ */
+static int conjunction_cache_query(const Catalog *catalog, double start_time, long duration_sec, double threshold_km,
+                                   ConjunctionSet *set, SieveStats *stats) {
+    size_t first;
+    double lo;
+    ConjunctionTable *table = conjunction_cache_acquire(catalog, start_time, duration_sec, threshold_km, &first, &lo);
+    if (!table) return 0;
+    int result = 1;
+    for (size_t k = first; k < table->count && table->approaches[k].min_time <= lo + duration_sec; ++k) {
+        const Conjunction *c = &table->approaches[k];
+        if (c->min_dist >= threshold_km) continue;
+        if (!conjunction_set_update(set, c->i, c->j, c->min_dist, c->min_time - lo)) { result = -1; break; }
     }
-    fclose(f);
-    return count;
+    *stats = table->stats;
+    conjunction_cache_release(table);
+    return result;
 }
 
-// --- NEW: Load SATCAT data from sat_data.txt ---
-static int load_satcat_file(const char* filename, SatCatData satcat_db[], int max_sats) {
-    FILE* f = fopen(filename, "r");
-    if (!f) return -1;
-    char line[512]; // Increased buffer for long SATCAT lines
-    int count = 0;
-    while (count < max_sats && fgets(line, sizeof(line), f)) {
-        if (strlen(line) < 100) continue; // Skip malformed lines
-
-        char norad_str[6];
-        strncpy(norad_str, line + 13, 5);
-        norad_str[5] = '\0';
-        satcat_db[count].norad_id = atoi(norad_str);
-
-        char name_buf[64];
-        strncpy(name_buf, line + 23, 25);
-        name_buf[25] = '\0';
-        trim_newline(name_buf);
-        strcpy(satcat_db[count].official_name, name_buf);
-
-        char country_buf[16];
-        strncpy(country_buf, line + 49, 5);
-        country_buf[5] = '\0';
-        trim_newline(country_buf);
-        strcpy(satcat_db[count].country, country_buf);
-
-        char launch_date_buf[12];
-        strncpy(launch_date_buf, line + 64, 10);
-        launch_date_buf[10] = '\0';
-        strcpy(satcat_db[count].launch_date, launch_date_buf);
-        
-        // Simple status check based on decay date
-        if (line[83] == ' ' || line[83] == '0') {
-            strcpy(satcat_db[count].status, "Active");
-        } else {
-            strcpy(satcat_db[count].status, "Decayed/Inactive");
-        }
+/*
+ * Slides the table to start at `now`: past approaches are dropped, the rest
+ * are rebased, and only the tail beyond the old horizon is screened. The
+ * tail starts one refine step before the seam and each side keeps only the
+ * approaches on its own side, so a TCA the old window clipped at its end is
+ * taken from the tail instead. Returns 0 when the table needs a full build.
+ */
+static int conjunction_cache_roll(double now) {
+    pthread_mutex_lock(&CONJ_CACHE.lock);
+    ConjunctionTable *old = CONJ_CACHE.table;
+    int busy = CONJ_CACHE.building;
+    long begin = old ? (long)(now - old->start_time) : 0; /* the new start, as an old offset */
+    long seam = old ? old->horizon_sec : 0;
+    long from = seam - REFINE_STEP_SEC;
+    int rollable = !busy && old && from > begin;
+    if (rollable) {
+        old->refs++;
+        CONJ_CACHE.building = 1;
+    }
+    pthread_mutex_unlock(&CONJ_CACHE.lock);
+    if (busy) return 1;
+    if (!rollable) return 0;
 
-        // Dummy purpose for demonstration
-        switch(satcat_db[count].norad_id % 5) {
-            case 0: strcpy(satcat_db[count].purpose, "Communications"); break;
-            case 1: strcpy(satcat_db[count].purpose, "Earth Observation"); break;
-            case 2: strcpy(satcat_db[count].purpose, "Navigation"); break;
-            case 3: strcpy(satcat_db[count].purpose, "Scientific"); break;
-            default: strcpy(satcat_db[count].purpose, "Commercial"); break;
+    long horizon_sec = CACHE_HORIZON_DAYS * 86400L;
+    ApproachList tail = {0};
+    SieveStats stats = {0};
+    time_t began = time(NULL);
+    Catalog *catalog = catalog_acquire();
+    int ok = conjunction_cache_screen(catalog, old->start_time + from, begin + horizon_sec - from, NULL, &tail, &stats);
+    size_t first = conjunction_table_lower_bound(old, begin);
+    Conjunction *approaches = ok ? malloc(sizeof(Conjunction) * (old->count - first + tail.count + 1)) : NULL;
+    ConjunctionTable *table = approaches ? malloc(sizeof(ConjunctionTable)) : NULL;
+    size_t count = 0, kept = 0;
+    if (table) {
+        for (size_t k = first; k < old->count && old->approaches[k].min_time < seam; ++k) {
+            approaches[count] = old->approaches[k];
+            approaches[count++].min_time -= begin;
         }
+        kept = count;
+        qsort(tail.items, tail.count, sizeof(Conjunction), compare_approach_times);
+        for (size_t k = 0; k < tail.count; ++k) {
+            if (tail.items[k].min_time + from < seam) continue;
+            approaches[count] = tail.items[k];
+            approaches[count++].min_time += from - begin;
+        }
+        *table = (ConjunctionTable){
+            .refs = 1,
+            .generation = catalog->generation,
+            .start_time = old->start_time + begin,
+            .horizon_sec = horizon_sec,
+            .ceiling_km = old->ceiling_km,
+            .approaches = approaches,
+            .count = count,
+            .stats = old->stats,
+        };
+    } else {
+        free(approaches);
+    }
+    approach_list_free(&tail);
+    catalog_release(catalog);
+    if (conjunction_cache_install(table)) conjunction_cache_spawn();
+    conjunction_cache_release(old);
+    if (table) {
+        printf("Conjunction cache: rolled %lds forward, kept %zu approaches and screened %zu in %lds.\n",
+               begin, kept, count - kept, (long)(time(NULL) - began));
+    }
+    return table != NULL;
+}
+
+/*
+ * Brings the table up to date after an update published `catalog`:
+ * approaches involving a `changed` object are dropped and only pairs with a
+ * changed object are screened, over what is left of the window from `now`,
+ * so the cost scales with changed x catalog. Returns 0 when the table needs
+ * a full build instead.
+ */
+static int conjunction_cache_rescreen(const Catalog *catalog, const char *changed, double now) {
+    pthread_mutex_lock(&CONJ_CACHE.lock);
+    ConjunctionTable *old = CONJ_CACHE.table;
+    int busy = CONJ_CACHE.building;
+    long begin = old ? (long)(now - old->start_time) : 0;
+    int usable = !busy && old && begin < old->horizon_sec;
+    if (usable) {
+        old->refs++;
+        CONJ_CACHE.building = 1;
+    } else if (busy) {
+        CONJ_CACHE.pending = 1; /* what is running may have screened the old elements */
+    }
+    pthread_mutex_unlock(&CONJ_CACHE.lock);
+    if (busy) return 1;
+    if (!usable) return 0;
 
-        count++;
+    ApproachList fresh = {0};
+    SieveStats stats = {0};
+    time_t began = time(NULL);
+    int ok = conjunction_cache_screen(catalog, old->start_time + begin, old->horizon_sec - begin, changed, &fresh, &stats);
+    size_t first = conjunction_table_lower_bound(old, begin);
+    Conjunction *approaches = ok ? malloc(sizeof(Conjunction) * (old->count - first + fresh.count + 1)) : NULL;
+    ConjunctionTable *table = approaches ? malloc(sizeof(ConjunctionTable)) : NULL;
+    size_t count = 0, kept = 0;
+    if (table) {
+        for (size_t k = first; k < old->count; ++k) {
+            const Conjunction *c = &old->approaches[k];
+            if (changed[c->i] || changed[c->j]) continue;
+            approaches[count] = *c;
+            approaches[count++].min_time -= begin;
+        }
+        kept = count;
+        memcpy(approaches + count, fresh.items, sizeof(Conjunction) * fresh.count);
+        count += fresh.count;
+        qsort(approaches, count, sizeof(Conjunction), compare_approach_times);
+        *table = (ConjunctionTable){
+            .refs = 1,
+            .generation = catalog->generation,
+            .start_time = old->start_time + begin,
+            .horizon_sec = old->horizon_sec - begin,
+            .ceiling_km = old->ceiling_km,
+            .approaches = approaches,
+            .count = count,
+            .stats = old->stats,
+        };
+    } else {
+        free(approaches);
     }
-    fclose(f);
-    return count;
+    approach_list_free(&fresh);
+    if (conjunction_cache_install(table)) conjunction_cache_spawn();
+    conjunction_cache_release(old);
+    if (table) {
+        printf("Conjunction cache: kept %zu approaches and rescreened changed objects to %zu in %lds.\n",
+               kept, count - kept, (long)(time(NULL) - began));
+    }
+    return table != NULL;
 }
 
+/* Rolls the cache forward every CACHE_ROLL_SEC, rebuilding it when it cannot roll. */
+static void *conjunction_cache_keeper(void *arg) {
+    (void)arg;
+    for (;;) {
+        sleep(CACHE_ROLL_SEC);
+        if (!conjunction_cache_roll((double)time(NULL))) conjunction_cache_refresh();
+    }
+    return NULL;
+}
 
-void propagate_orbit(const Satellite *sat, double sim_time, double *x, double *y, double *z) {
-    if (!sat->valid) return;
-    double dt = sim_time - sat->epoch_time;
-    double n_rad_per_sec = sat->mean_motion * 2.0 * M_PI / 86400.0;
-    double M = sat->mean_anomaly + n_rad_per_sec * dt;
-    M = fmod(M, 2.0 * M_PI);
-    if (M < 0) M += 2.0 * M_PI;
-    double E = M;
-    for (int i = 0; i < 7; i++) {
-        E = E - (E - sat->eccentricity * sin(E) - M) / (1.0 - sat->eccentricity * cos(E));
-    }
-    double nu = 2.0 * atan2(sqrt(1.0 + sat->eccentricity) * sin(E / 2.0),
-                           sqrt(1.0 - sat->eccentricity) * cos(E / 2.0));
-    double r = sat->semi_major_axis * (1.0 - sat->eccentricity * cos(E));
-    double ox = r * cos(nu);
-    double oy = r * sin(nu);
-    double cos_raan = cos(sat->raan);
-    double sin_raan = sin(sat->raan);
-    double cos_argp = cos(sat->arg_perigee);
-    double sin_argp = sin(sat->arg_perigee);
-    double cos_inc = cos(sat->inclination);
-    double sin_inc = sin(sat->inclination);
-    *x = ox * (cos_raan * cos_argp - sin_raan * sin_argp * cos_inc) -
-         oy * (cos_raan * sin_argp + sin_raan * cos_argp * cos_inc);
-    *y = ox * (sin_raan * cos_argp + cos_raan * sin_argp * cos_inc) -
-         oy * (sin_raan * sin_argp - cos_raan * cos_argp * cos_inc);
-    *z = ox * (sin_argp * sin_inc) + oy * (cos_argp * sin_inc);
-}
-static int is_same_system(const char *name1, const char *name2) {
-    char prefix1[32], prefix2[32];
-    sscanf(name1, "%s", prefix1);
-    sscanf(name2, "%s", prefix2);
-    return (strlen(prefix1) > 2 && strcmp(prefix1, prefix2) == 0);
+/* Builds the cache and starts the thread that keeps its window current. */
+static void conjunction_cache_start(void) {
+    conjunction_cache_refresh();
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, conjunction_cache_keeper, NULL) != 0) {
+        fprintf(stderr, "Could not start the conjunction cache keeper; the cache will not roll forward.\n");
+        return;
+    }
+    pthread_detach(thread);
 }
+
 static size_t write_data(void *ptr, size_t size, size_t nmemb, FILE *stream) {
     return fwrite(ptr, size, nmemb, stream);
 }
@@ -285,6 +3615,54 @@ static int download_tle_file(const char *url, const char *output_filename) {
     return 1;
 }
 
+typedef struct {
+    const char *tle_url;
+    const char *tle_filename;
+    const char *satcat_url;
+    const char *satcat_filename;
+    int refresh_first; /* the catalog came from a snapshot, which may be old */
+} CatalogSource;
+
+/* Downloads `url` over `filename` only when the whole download succeeds; a failed one truncates its file. */
+static int download_replacing(const char *url, const char *filename) {
+    char partial[512];
+    snprintf(partial, sizeof(partial), "%s.part", filename);
+    return download_tle_file(url, partial) && rename(partial, filename) == 0;
+}
+
+/*
+ * Downloads the TLE catalog and SATCAT every CATALOG_REFRESH_SEC and applies
+ * them; requests are served from the old catalog until the new one is
+ * published, and the cache rescreens only the objects that changed.
+ */
+static void *catalog_keeper(void *arg) {
+    const CatalogSource *source = arg;
+    for (int first = 1;; first = 0) {
+        if (!first || !source->refresh_first) sleep(CATALOG_REFRESH_SEC);
+        int tle_ok = download_replacing(source->tle_url, source->tle_filename);
+        int satcat_ok = download_replacing(source->satcat_url, source->satcat_filename);
+        if (!tle_ok || !satcat_ok) {
+            fprintf(stderr, "Catalog refresh: %s download failed; keeping the current one.\n",
+                    !tle_ok && !satcat_ok ? "TLE and SATCAT" : !tle_ok ? "TLE" : "SATCAT");
+        }
+        if (!tle_ok && !satcat_ok) continue;
+        char *changed;
+        int changes = catalog_update(tle_ok ? source->tle_filename : NULL,
+                                     satcat_ok ? source->satcat_filename : NULL, &changed);
+        if (changes < 0) {
+            fprintf(stderr, "Catalog refresh: could not apply the downloaded catalog.\n");
+            continue;
+        }
+        printf("Catalog refresh: %d objects changed%s.\n", changes, satcat_ok ? ", SATCAT reloaded" : "");
+        if (!catalog_snapshot_save(CATALOG_SNAPSHOT)) fprintf(stderr, "Could not write the catalog snapshot.\n");
+        Catalog *catalog = catalog_acquire();
+        if (changes > 0 && !conjunction_cache_rescreen(catalog, changed, (double)time(NULL))) conjunction_cache_refresh();
+        catalog_release(catalog);
+        free(changed);
+    }
+    return NULL;
+}
+
 // --- USER MANAGEMENT & UTILS (Unchanged)---
 void simple_hash(const char *str, char *output) {
     unsigned long hash = 5381;
@@ -391,16 +3769,16 @@ int is_pro_user(User* user) {
 }
 
 // --- API HANDLERS ---
-char* handle_list_sats() {
+char* handle_list_sats(const Catalog* catalog) {
     cJSON *root = cJSON_CreateObject();
     cJSON *satellites = cJSON_CreateArray();
     cJSON_AddItemToObject(root, "satellites", satellites);
-    for (int i = 0; i < SATS_COUNT; ++i) {
-        if (!SATS_DB[i].valid) continue;
+    for (int i = 0; i < catalog->count; ++i) {
+        if (!catalog->sats[i].valid) continue;
         cJSON *sat = cJSON_CreateObject();
-        cJSON_AddStringToObject(sat, "name", SATS_DB[i].name);
-        cJSON_AddNumberToObject(sat, "altitude", SATS_DB[i].altitude);
-        cJSON_AddNumberToObject(sat, "norad_id", SATS_DB[i].norad_id);
+        cJSON_AddStringToObject(sat, "name", catalog->sats[i].name);
+        cJSON_AddNumberToObject(sat, "altitude", catalog->sats[i].altitude);
+        cJSON_AddNumberToObject(sat, "norad_id", catalog->sats[i].norad_id);
         cJSON_AddItemToArray(satellites, sat);
     }
     char *json_string = cJSON_Print(root);
@@ -408,7 +3786,7 @@ char* handle_list_sats() {
     return json_string;
 }
 
-char* handle_filter_sats(const cJSON *json) {
+char* handle_filter_sats(const Catalog* catalog, const cJSON *json) {
     const cJSON *min_alt_json = cJSON_GetObjectItem(json, "min_alt");
     const cJSON *max_alt_json = cJSON_GetObjectItem(json, "max_alt");
     if (!min_alt_json || !max_alt_json || !cJSON_IsNumber(min_alt_json) || !cJSON_IsNumber(max_alt_json)) return NULL;
@@ -419,13 +3797,13 @@ char* handle_filter_sats(const cJSON *json) {
     cJSON *root = cJSON_CreateObject();
     cJSON *satellites = cJSON_CreateArray();
     cJSON_AddItemToObject(root, "satellites", satellites);
-    for (int i = 0; i < SATS_COUNT; ++i) {
-        if (!SATS_DB[i].valid) continue;
-        if (SATS_DB[i].altitude >= min_alt && SATS_DB[i].altitude <= max_alt) {
+    for (int i = 0; i < catalog->count; ++i) {
+        if (!catalog->sats[i].valid) continue;
+        if (catalog->sats[i].altitude >= min_alt && catalog->sats[i].altitude <= max_alt) {
             cJSON *sat = cJSON_CreateObject();
-            cJSON_AddStringToObject(sat, "name", SATS_DB[i].name);
-            cJSON_AddNumberToObject(sat, "altitude", SATS_DB[i].altitude);
-            cJSON_AddNumberToObject(sat, "norad_id", SATS_DB[i].norad_id);
+            cJSON_AddStringToObject(sat, "name", catalog->sats[i].name);
+            cJSON_AddNumberToObject(sat, "altitude", catalog->sats[i].altitude);
+            cJSON_AddNumberToObject(sat, "norad_id", catalog->sats[i].norad_id);
             cJSON_AddItemToArray(satellites, sat);
         }
     }
@@ -434,7 +3812,7 @@ char* handle_filter_sats(const cJSON *json) {
     return json_string;
 }
 
-char* handle_risk_check(const cJSON* json) {
+char* handle_risk_check(const Catalog* catalog, const cJSON* json) {
     const cJSON *target_alt_json = cJSON_GetObjectItem(json, "target_alt");
     const cJSON *tolerance_json = cJSON_GetObjectItem(json, "tolerance");
     if (!target_alt_json || !tolerance_json || !cJSON_IsNumber(target_alt_json) || !cJSON_IsNumber(tolerance_json)) return NULL;
@@ -446,13 +3824,13 @@ char* handle_risk_check(const cJSON* json) {
     cJSON *risks = cJSON_CreateArray();
     cJSON_AddItemToObject(root, "risks", risks);
     int found = 0;
-    for (int i = 0; i < SATS_COUNT; ++i) {
-        if (!SATS_DB[i].valid) continue;
-        if (fabs(SATS_DB[i].altitude - target) <= tolerance) {
+    for (int i = 0; i < catalog->count; ++i) {
+        if (!catalog->sats[i].valid) continue;
+        if (fabs(catalog->sats[i].altitude - target) <= tolerance) {
             cJSON *risk_item = cJSON_CreateObject();
-            cJSON_AddStringToObject(risk_item, "name", SATS_DB[i].name);
-            cJSON_AddNumberToObject(risk_item, "altitude", SATS_DB[i].altitude);
-            cJSON_AddNumberToObject(risk_item, "norad_id", SATS_DB[i].norad_id);
+            cJSON_AddStringToObject(risk_item, "name", catalog->sats[i].name);
+            cJSON_AddNumberToObject(risk_item, "altitude", catalog->sats[i].altitude);
+            cJSON_AddNumberToObject(risk_item, "norad_id", catalog->sats[i].norad_id);
             cJSON_AddItemToArray(risks, risk_item);
             found = 1;
         }
@@ -463,58 +3841,282 @@ char* handle_risk_check(const cJSON* json) {
     return json_string;
 }
 
-char* handle_predict_collisions(const cJSON* json, User* user) {
-    if (!is_pro_user(user)) { return strdup("{\"error\":\"This is a Pro feature. Please upgrade your plan.\"}"); }
-    
+/* ISO-8601 UTC with milliseconds, e.g. 2025-10-09T12:34:56.789Z */
+static void format_utc(double unix_time, char *out, size_t len) {
+    time_t whole = (time_t)floor(unix_time);
+    int millis = (int)((unix_time - (double)whole) * 1000.0);
+    if (millis > 999) millis = 999;
+    struct tm tm_utc;
+    gmtime_r(&whole, &tm_utc);
+    char base[24];
+    strftime(base, sizeof(base), "%Y-%m-%dT%H:%M:%S", &tm_utc);
+    snprintf(out, len, "%s.%03dZ", base, millis);
+}
+
+static void add_screening_stats(cJSON *root, const SieveStats *stats) {
+    cJSON *screening = cJSON_CreateObject();
+    cJSON_AddNumberToObject(screening, "pairs", (double)stats->pairs);
+    cJSON_AddNumberToObject(screening, "apsis_rejected", (double)stats->apsis_rejected);
+    cJSON_AddNumberToObject(screening, "orbit_path_rejected", (double)stats->orbit_path_rejected);
+    cJSON_AddNumberToObject(screening, "time_rejected", (double)stats->time_rejected);
+    cJSON_AddNumberToObject(screening, "passed", (double)stats->passed);
+    cJSON_AddNumberToObject(screening, "skipped", (double)stats->skipped);
+    cJSON_AddNumberToObject(screening, "excluded", (double)stats->excluded);
+    cJSON_AddItemToObject(root, "screening", screening);
+}
+
+/* Reads an optional "model": "sgp4" (the default), "j2" or "kepler"; 0 if it is invalid. */
+static int parse_model(const cJSON* json, PropagationModel* model) {
+    const cJSON *model_json = cJSON_GetObjectItem(json, "model");
+    *model = MODEL_SGP4;
+    if (!model_json) return 1;
+    if (!cJSON_IsString(model_json)) return 0;
+    if (strcmp(model_json->valuestring, "sgp4") == 0) return 1;
+    if (strcmp(model_json->valuestring, "j2") == 0) { *model = MODEL_J2; return 1; }
+    if (strcmp(model_json->valuestring, "kepler") == 0) { *model = MODEL_KEPLER; return 1; }
+    return 0;
+}
+
+/* Reads an optional "exclude": "constellation" (the default), "launch", "either" or "none"; 0 if it is invalid. */
+static int parse_exclusion(const cJSON* json, ExclusionPolicy* policy) {
+    const cJSON *exclude_json = cJSON_GetObjectItem(json, "exclude");
+    *policy = EXCLUDE_CONSTELLATION;
+    if (!exclude_json) return 1;
+    if (!cJSON_IsString(exclude_json)) return 0;
+    if (strcmp(exclude_json->valuestring, "constellation") == 0) return 1;
+    if (strcmp(exclude_json->valuestring, "launch") == 0) { *policy = EXCLUDE_LAUNCH; return 1; }
+    if (strcmp(exclude_json->valuestring, "either") == 0) { *policy = EXCLUDE_EITHER; return 1; }
+    if (strcmp(exclude_json->valuestring, "none") == 0) { *policy = EXCLUDE_NONE; return 1; }
+    return 0;
+}
+
+/* Reads /predict's duration, step, threshold, refine, top_k, model and exclusion policy into `params`; 0 if they are invalid. */
+static int parse_predict_params(const Catalog* catalog, const cJSON* json, ScreenParams* params) {
     const cJSON *duration_json = cJSON_GetObjectItem(json, "duration");
     const cJSON *step_json = cJSON_GetObjectItem(json, "step");
     const cJSON *threshold_json = cJSON_GetObjectItem(json, "threshold");
-    if (!duration_json || !step_json || !threshold_json || !cJSON_IsNumber(duration_json) || !cJSON_IsNumber(step_json) || !cJSON_IsNumber(threshold_json)) return NULL;
+    if (!duration_json || !step_json || !threshold_json || !cJSON_IsNumber(duration_json) || !cJSON_IsNumber(step_json) || !cJSON_IsNumber(threshold_json)) return 0;
 
     int duration_days = duration_json->valueint;
     int time_step_min = step_json->valueint;
-    double threshold_km = threshold_json->valuedouble;
+    if (time_step_min <= 0) return 0;
+    const cJSON *refine_json = cJSON_GetObjectItem(json, "refine");
+    const cJSON *top_k_json = cJSON_GetObjectItem(json, "top_k");
+    if (top_k_json && (!cJSON_IsNumber(top_k_json) || top_k_json->valueint <= 0)) return 0;
+    PropagationModel model;
+    ExclusionPolicy exclude;
+    if (!parse_model(json, &model) || !parse_exclusion(json, &exclude)) return 0;
+
+    *params = (ScreenParams){
+        .sats = catalog->sats,
+        .count = catalog->count,
+        .start_time = (double)time(NULL),
+        .duration_sec = (long)duration_days * 86400,
+        .step_sec = (long)time_step_min * 60,
+        .threshold_km = threshold_json->valuedouble,
+        .refine = cJSON_IsTrue(refine_json),
+        .top_k = top_k_json ? (top_k_json->valueint < MAX_TOP_K ? top_k_json->valueint : MAX_TOP_K) : 0,
+        .model = model,
+        .exclude = exclude,
+    };
+    return 1;
+}
+
+static cJSON *predict_event_json(const Conjunction *c, const ScreenParams *params) {
+    cJSON *event = cJSON_CreateObject();
+    cJSON_AddStringToObject(event, "object1_name", params->sats[c->i].name);
+    cJSON_AddStringToObject(event, "object2_name", params->sats[c->j].name);
+    cJSON_AddNumberToObject(event, "min_distance_km", c->min_dist);
+    cJSON_AddNumberToObject(event, "time_from_now_hr", c->min_time / 3600.0);
+    if (params->refine) {
+        char tca_utc[48];
+        format_utc(params->start_time + c->min_time, tca_utc, sizeof(tca_utc));
+        cJSON_AddStringToObject(event, "tca_utc", tca_utc);
+    }
+    return event;
+}
+
+char* handle_predict_collisions(const Catalog* catalog, const cJSON* json, User* user, ScreenProgress* progress, void* arg) {
+    (void)arg;
+    if (!is_pro_user(user)) { return strdup("{\"error\":\"This is a Pro feature. Please upgrade your plan.\"}"); }
+
+    ScreenParams params;
+    if (!parse_predict_params(catalog, json, &params)) return NULL;
+    params.progress = progress;
+    ConjunctionSet set;
+    SieveStats stats = {0};
+    if (!conjunction_set_init(&set, 1024)) return strdup("{\"error\":\"Out of memory.\"}");
+    /* Refined SGP4 requests with the default exclusions are served from the background cache when they fit in it. */
+    int cached = params.refine && params.model == MODEL_SGP4 && params.exclude == EXCLUDE_CONSTELLATION
+        ? conjunction_cache_query(catalog, params.start_time, params.duration_sec, params.threshold_km, &set, &stats) : 0;
+    if (cached < 0 || (!cached && !screen_catalog(&params, &set, &stats))) {
+        conjunction_set_free(&set);
+        return strdup("{\"error\":\"Out of memory.\"}");
+    }
+    size_t found = 0;
+    Conjunction *conj = conjunction_set_sorted(&set, &found);
+    /* top_k: the closest first; the cache answers with every pair, so cut here too. */
+    if (params.top_k) qsort(conj, found, sizeof(Conjunction), compare_conjunction_distances);
 
-    const double MIN_DIST_KM = 0.01;
-    long duration_sec = duration_days * 86400;
-    long step_sec = time_step_min * 60;
-    time_t now = time(NULL);
     cJSON *root = cJSON_CreateObject();
     cJSON *events = cJSON_CreateArray();
     cJSON_AddItemToObject(root, "events", events);
-    for (int i = 0; i < SATS_COUNT; ++i) {
-        if (!SATS_DB[i].valid) continue;
-        for (int j = i + 1; j < SATS_COUNT; ++j) {
-            if (!SATS_DB[j].valid) continue;
-            if (is_same_system(SATS_DB[i].name, SATS_DB[j].name)) continue;
-            double min_dist = 1e9, min_time = 0;
-            for (long t = 0; t <= duration_sec; t += step_sec) {
-                double sim_time = now + t;
-                double x1, y1, z1, x2, y2, z2;
-                propagate_orbit(&SATS_DB[i], sim_time, &x1, &y1, &z1);
-                propagate_orbit(&SATS_DB[j], sim_time, &x2, &y2, &z2);
-                double dist = sqrt(pow(x1 - x2, 2) + pow(y1 - y2, 2) + pow(z1 - z2, 2));
-                if (dist < min_dist) {
-                    min_dist = dist;
-                    min_time = (double)t / 3600.0;
-                }
-            }
-            if (min_dist < threshold_km && min_dist > MIN_DIST_KM) {
-                cJSON *event = cJSON_CreateObject();
-                cJSON_AddStringToObject(event, "object1_name", SATS_DB[i].name);
-                cJSON_AddStringToObject(event, "object2_name", SATS_DB[j].name);
-                cJSON_AddNumberToObject(event, "min_distance_km", min_dist);
-                cJSON_AddNumberToObject(event, "time_from_now_hr", min_time);
-                cJSON_AddItemToArray(events, event);
+    int emitted = 0;
+    for (size_t k = 0; k < found && (!params.top_k || emitted < params.top_k); ++k) {
+        if (conj[k].min_dist <= MIN_DIST_KM) continue;
+        cJSON_AddItemToArray(events, predict_event_json(&conj[k], &params));
+        emitted++;
+    }
+    conjunction_set_free(&set);
+    cJSON_AddBoolToObject(root, "cached", cached);
+    add_screening_stats(root, &stats);
+    char *json_string = cJSON_Print(root);
+    cJSON_Delete(root);
+    return json_string;
+}
+
+static int compare_conjunction_times(const void *a, const void *b) {
+    const Conjunction *ca = *(const Conjunction *const *)a, *cb = *(const Conjunction *const *)b;
+    return (ca->min_time > cb->min_time) - (ca->min_time < cb->min_time);
+}
+
+/*
+ * Screens an operator's own satellites (NORAD ids in "norad_ids") against the
+ * whole catalog. Only pairs involving a primary are sieved and swept, so the
+ * cost scales with primaries x catalog instead of catalog^2. Events are
+ * grouped per primary and ordered by time.
+ */
+char* handle_screen_primaries(const Catalog* catalog, const cJSON* json, User* user, ScreenProgress* progress, void* arg) {
+    (void)arg;
+    if (!is_pro_user(user)) { return strdup("{\"error\":\"This is a Pro feature. Please upgrade your plan.\"}"); }
+
+    const cJSON *ids_json = cJSON_GetObjectItem(json, "norad_ids");
+    const cJSON *duration_json = cJSON_GetObjectItem(json, "duration");
+    const cJSON *step_json = cJSON_GetObjectItem(json, "step");
+    const cJSON *threshold_json = cJSON_GetObjectItem(json, "threshold");
+    if (!cJSON_IsArray(ids_json) || cJSON_GetArraySize(ids_json) == 0 || !cJSON_IsNumber(duration_json)
+        || !cJSON_IsNumber(step_json) || !cJSON_IsNumber(threshold_json)) return NULL;
+    if (step_json->valueint <= 0) return NULL;
+    PropagationModel model;
+    ExclusionPolicy exclude;
+    if (!parse_model(json, &model) || !parse_exclusion(json, &exclude)) return NULL;
+
+    char *primary = calloc(catalog->count > 0 ? catalog->count : 1, 1);
+    int *slot = malloc(sizeof(int) * (catalog->count > 0 ? catalog->count : 1));
+    int *members = malloc(sizeof(int) * cJSON_GetArraySize(ids_json));
+    if (!primary || !slot || !members) {
+        free(primary); free(slot); free(members);
+        return strdup("{\"error\":\"Out of memory.\"}");
+    }
+    for (int i = 0; i < catalog->count; ++i) slot[i] = -1;
+
+    cJSON *root = cJSON_CreateObject();
+    cJSON *primaries = cJSON_CreateArray();
+    cJSON *not_found = cJSON_CreateArray();
+    cJSON_AddItemToObject(root, "primaries", primaries);
+    cJSON_AddItemToObject(root, "not_found", not_found);
+    int count = 0;
+    const cJSON *id_json;
+    cJSON_ArrayForEach(id_json, ids_json) {
+        if (!cJSON_IsNumber(id_json)) continue;
+        int found = -1;
+        for (int i = 0; i < catalog->count && found < 0; ++i) {
+            if (catalog->sats[i].valid && catalog->sats[i].norad_id == id_json->valueint) found = i;
+        }
+        if (found < 0) { cJSON_AddItemToArray(not_found, cJSON_CreateNumber(id_json->valueint)); continue; }
+        if (slot[found] >= 0) continue;
+        slot[found] = count;
+        members[count++] = found;
+        primary[found] = 1;
+    }
+
+    ScreenParams params = {
+        .sats = catalog->sats,
+        .count = catalog->count,
+        .start_time = (double)time(NULL),
+        .duration_sec = (long)duration_json->valueint * 86400,
+        .step_sec = (long)step_json->valueint * 60,
+        .threshold_km = threshold_json->valuedouble,
+        .refine = cJSON_IsTrue(cJSON_GetObjectItem(json, "refine")),
+        .primary = primary,
+        .progress = progress,
+        .model = model,
+        .exclude = exclude,
+    };
+    ConjunctionSet set = {0};
+    SieveStats stats = {0};
+    size_t found = 0;
+    Conjunction *conj = NULL;
+    const Conjunction **by_primary = NULL;
+    int *offset = calloc(count + 1, sizeof(int));
+    int ok = offset && conjunction_set_init(&set, 256);
+    if (ok) {
+        ok = count == 0 || screen_catalog(&params, &set, &stats);
+        conj = conjunction_set_sorted(&set, &found);
+    }
+    /* Bucket the events by primary; a primary-primary event lands in both lists. */
+    if (ok) {
+        for (size_t k = 0; k < found; ++k) {
+            if (conj[k].min_dist <= MIN_DIST_KM) continue;
+            if (primary[conj[k].i]) offset[slot[conj[k].i] + 1]++;
+            if (primary[conj[k].j]) offset[slot[conj[k].j] + 1]++;
+        }
+        for (int m = 0; m < count; ++m) offset[m + 1] += offset[m];
+        by_primary = malloc(sizeof(Conjunction *) * (offset[count] > 0 ? offset[count] : 1));
+        ok = by_primary != NULL;
+    }
+    if (ok) {
+        int *fill = calloc(count + 1, sizeof(int));
+        ok = fill != NULL;
+        for (size_t k = 0; ok && k < found; ++k) {
+            if (conj[k].min_dist <= MIN_DIST_KM) continue;
+            if (primary[conj[k].i]) { int m = slot[conj[k].i]; by_primary[offset[m] + fill[m]++] = &conj[k]; }
+            if (primary[conj[k].j]) { int m = slot[conj[k].j]; by_primary[offset[m] + fill[m]++] = &conj[k]; }
+        }
+        free(fill);
+    }
+    for (int m = 0; ok && m < count; ++m) {
+        int own = members[m];
+        qsort(by_primary + offset[m], offset[m + 1] - offset[m], sizeof(Conjunction *), compare_conjunction_times);
+        cJSON *entry = cJSON_CreateObject();
+        cJSON_AddNumberToObject(entry, "norad_id", catalog->sats[own].norad_id);
+        cJSON_AddStringToObject(entry, "name", catalog->sats[own].name);
+        cJSON *events = cJSON_CreateArray();
+        cJSON_AddItemToObject(entry, "events", events);
+        for (int k = offset[m]; k < offset[m + 1]; ++k) {
+            const Conjunction *c = by_primary[k];
+            int other = c->i == own ? c->j : c->i;
+            cJSON *event = cJSON_CreateObject();
+            cJSON_AddNumberToObject(event, "norad_id", catalog->sats[other].norad_id);
+            cJSON_AddStringToObject(event, "object_name", catalog->sats[other].name);
+            cJSON_AddNumberToObject(event, "min_distance_km", c->min_dist);
+            cJSON_AddNumberToObject(event, "time_from_now_hr", c->min_time / 3600.0);
+            if (params.refine) {
+                char tca_utc[48];
+                format_utc(params.start_time + c->min_time, tca_utc, sizeof(tca_utc));
+                cJSON_AddStringToObject(event, "tca_utc", tca_utc);
             }
+            cJSON_AddItemToArray(events, event);
         }
+        cJSON_AddItemToArray(primaries, entry);
     }
+    conjunction_set_free(&set);
+    free(by_primary);
+    free(offset);
+    free(members);
+    free(slot);
+    free(primary);
+    if (!ok) {
+        cJSON_Delete(root);
+        return strdup("{\"error\":\"Out of memory.\"}");
+    }
+    add_screening_stats(root, &stats);
     char *json_string = cJSON_Print(root);
     cJSON_Delete(root);
     return json_string;
 }
 
-char* handle_safe_path(const cJSON* json, User* user) {
+char* handle_safe_path(const Catalog* catalog, const cJSON* json, User* user) {
     if (!is_pro_user(user)) { return strdup("{\"error\":\"This is a Pro feature. Please upgrade your plan.\"}"); }
     
     const cJSON *target_alt_json = cJSON_GetObjectItem(json, "target_alt");
@@ -524,9 +4126,9 @@ char* handle_safe_path(const cJSON* json, User* user) {
     #define MAX_ALTITUDE_BINS 1000
     #define ALTITUDE_BIN_SIZE 20
     int altitude_bins[MAX_ALTITUDE_BINS] = {0};
-    for (int i = 0; i < SATS_COUNT; ++i) {
-        if (!SATS_DB[i].valid || SATS_DB[i].altitude < 0) continue;
-        int bin_index = (int)(SATS_DB[i].altitude / ALTITUDE_BIN_SIZE);
+    for (int i = 0; i < catalog->count; ++i) {
+        if (!catalog->sats[i].valid || catalog->sats[i].altitude < 0) continue;
+        int bin_index = (int)(catalog->sats[i].altitude / ALTITUDE_BIN_SIZE);
         if (bin_index >= 0 && bin_index < MAX_ALTITUDE_BINS) {
             altitude_bins[bin_index]++;
         }
@@ -561,7 +4163,7 @@ char* handle_safe_path(const cJSON* json, User* user) {
 }
 
 // --- MODIFIED: Handler for mission details using real SATCAT data ---
-char* handle_details(const cJSON* json) {
+char* handle_details(const Catalog* catalog, const cJSON* json) {
     const cJSON* norad_id_json = cJSON_GetObjectItem(json, "norad_id");
     if (!norad_id_json || !cJSON_IsNumber(norad_id_json)) return NULL;
 
@@ -569,9 +4171,9 @@ char* handle_details(const cJSON* json) {
     SatCatData* sat_details = NULL;
 
     // Search for the satellite in our loaded SATCAT database
-    for (int i = 0; i < SATCAT_COUNT; i++) {
-        if (SATCAT_DB[i].norad_id == norad_id) {
-            sat_details = &SATCAT_DB[i];
+    for (int i = 0; i < catalog->satcat_count; i++) {
+        if (catalog->satcat[i].norad_id == norad_id) {
+            sat_details = &catalog->satcat[i];
             break;
         }
     }
@@ -685,6 +4287,204 @@ char* handle_generate_key(User* user) {
     return json_string;
 }
 
+// --- Async Jobs ---
+/*
+ * Every screening request is a job. JOB_RUNNERS threads work through the
+ * queue in submission order, so at most that many heavy computations run at
+ * a time however many connections are open; they share the worker pool.
+ * A request sent with "async": true is answered at once with a job id, and
+ * the client polls POST /jobs/{id} for status, progress and finally the
+ * result. Any other request waits on its connection for its job.
+ */
+/* `arg` is the handler's own, given at submission: the stream queue of a streaming /predict. */
+typedef char *(*JobHandler)(const Catalog *catalog, const cJSON *json, User *user, ScreenProgress *progress, void *arg);
+
+typedef enum { JOB_FREE, JOB_QUEUED, JOB_RUNNING, JOB_DONE } JobState;
+
+typedef struct {
+    JobState state;
+    char id[33];
+    unsigned long seq;      /* submission order */
+    User *user;
+    JobHandler handler;
+    void *arg;
+    cJSON *request;         /* copy of the request body until the job runs */
+    ScreenProgress progress;
+    char *result;           /* handler output; NULL when the parameters were rejected */
+    time_t finished;
+    int waited;             /* a connection waits for the result and frees the job */
+} Job;
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t wake;    /* a job was queued */
+    pthread_cond_t done;    /* a job finished */
+    Job jobs[MAX_JOBS];
+    unsigned long next_seq;
+    int runners;
+} JOB_QUEUE = { .lock = PTHREAD_MUTEX_INITIALIZER, .wake = PTHREAD_COND_INITIALIZER, .done = PTHREAD_COND_INITIALIZER };
+
+/* Oldest queued job, or NULL. Caller holds JOB_QUEUE.lock. */
+static Job *job_queue_next(void) {
+    Job *next = NULL;
+    for (int k = 0; k < MAX_JOBS; ++k) {
+        Job *job = &JOB_QUEUE.jobs[k];
+        if (job->state == JOB_QUEUED && (!next || job->seq < next->seq)) next = job;
+    }
+    return next;
+}
+
+static void *job_runner(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&JOB_QUEUE.lock);
+    while (1) {
+        Job *job;
+        while (!(job = job_queue_next())) pthread_cond_wait(&JOB_QUEUE.wake, &JOB_QUEUE.lock);
+        job->state = JOB_RUNNING;
+        pthread_mutex_unlock(&JOB_QUEUE.lock);
+        Catalog *catalog = catalog_acquire();
+        char *result = job->handler(catalog, job->request, job->user, &job->progress, job->arg);
+        catalog_release(catalog);
+        pthread_mutex_lock(&JOB_QUEUE.lock);
+        cJSON_Delete(job->request);
+        job->request = NULL;
+        job->result = result;
+        job->finished = time(NULL);
+        job->state = JOB_DONE;
+        pthread_cond_broadcast(&JOB_QUEUE.done);
+    }
+    return NULL;
+}
+
+static int job_runners_start(int count) {
+    for (int k = 0; k < count; ++k) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, job_runner, NULL) != 0) break;
+        pthread_detach(thread);
+        JOB_QUEUE.runners++;
+    }
+    return JOB_QUEUE.runners > 0;
+}
+
+/* Frees results older than JOB_TTL_SEC. Caller holds JOB_QUEUE.lock. */
+static void job_queue_expire(time_t now) {
+    for (int k = 0; k < MAX_JOBS; ++k) {
+        Job *job = &JOB_QUEUE.jobs[k];
+        if (job->state != JOB_DONE || job->waited || now - job->finished < JOB_TTL_SEC) continue;
+        free(job->result);
+        job->result = NULL;
+        job->state = JOB_FREE;
+    }
+}
+
+/* Queues a copy of the request; NULL with an error body in *error when the queue is full or out of memory. */
+static Job *job_queue_submit(const cJSON *json, User *user, JobHandler handler, void *arg, int waited, char **error) {
+    cJSON *request = cJSON_Duplicate(json, 1);
+    if (!request) { *error = strdup("{\"error\":\"Out of memory.\"}"); return NULL; }
+    pthread_mutex_lock(&JOB_QUEUE.lock);
+    job_queue_expire(time(NULL));
+    Job *job = NULL;
+    for (int k = 0; k < MAX_JOBS && !job; ++k) {
+        if (JOB_QUEUE.jobs[k].state == JOB_FREE) job = &JOB_QUEUE.jobs[k];
+    }
+    if (!job) {
+        pthread_mutex_unlock(&JOB_QUEUE.lock);
+        cJSON_Delete(request);
+        *error = strdup("{\"error\":\"Too many jobs in progress. Try again later.\"}");
+        return NULL;
+    }
+    *job = (Job){
+        .state = JOB_QUEUED,
+        .seq = JOB_QUEUE.next_seq++,
+        .user = user,
+        .handler = handler,
+        .arg = arg,
+        .request = request,
+        .waited = waited,
+    };
+    generate_random_string(job->id, sizeof(job->id));
+    pthread_cond_signal(&JOB_QUEUE.wake);
+    pthread_mutex_unlock(&JOB_QUEUE.lock);
+    return job;
+}
+
+/* Waits for a job queued with `waited` and frees it; returns its result. */
+static char *job_queue_wait(Job *job) {
+    pthread_mutex_lock(&JOB_QUEUE.lock);
+    while (job->state != JOB_DONE) pthread_cond_wait(&JOB_QUEUE.done, &JOB_QUEUE.lock);
+    char *result = job->result;
+    job->result = NULL;
+    job->state = JOB_FREE;
+    pthread_mutex_unlock(&JOB_QUEUE.lock);
+    return result;
+}
+
+char* handle_submit_job(const cJSON* json, User* user, JobHandler handler) {
+    char *error = NULL;
+    Job *job = job_queue_submit(json, user, handler, NULL, 0, &error);
+    if (!job) return error;
+    cJSON *root = cJSON_CreateObject();
+    pthread_mutex_lock(&JOB_QUEUE.lock);
+    cJSON_AddStringToObject(root, "job_id", job->id);
+    pthread_mutex_unlock(&JOB_QUEUE.lock);
+    cJSON_AddStringToObject(root, "status", "queued");
+    char *json_string = cJSON_Print(root);
+    cJSON_Delete(root);
+    return json_string;
+}
+
+/*
+ * Queues a screening handler as a job, which screens the catalog current
+ * when it runs. With "async" the job id is returned at once; otherwise the
+ * caller waits for the result. Without job runners the handler runs inline
+ * on `catalog`.
+ */
+char* handle_screening_request(const Catalog* catalog, const cJSON* json, User* user, JobHandler handler) {
+    if (!is_pro_user(user)) { return strdup("{\"error\":\"This is a Pro feature. Please upgrade your plan.\"}"); }
+    int async = cJSON_IsTrue(cJSON_GetObjectItem(json, "async"));
+    if (JOB_QUEUE.runners == 0) {
+        return async ? strdup("{\"error\":\"Async jobs are unavailable.\"}") : handler(catalog, json, user, NULL, NULL);
+    }
+    if (async) return handle_submit_job(json, user, handler);
+    char *error = NULL;
+    Job *job = job_queue_submit(json, user, handler, NULL, 1, &error);
+    return job ? job_queue_wait(job) : error;
+}
+
+char* handle_job_status(const char* id, User* user) {
+    cJSON *root = cJSON_CreateObject();
+    pthread_mutex_lock(&JOB_QUEUE.lock);
+    Job *job = NULL;
+    for (int k = 0; k < MAX_JOBS && !job; ++k) {
+        Job *candidate = &JOB_QUEUE.jobs[k];
+        if (candidate->state != JOB_FREE && candidate->user == user && strcmp(candidate->id, id) == 0) job = candidate;
+    }
+    if (!job) {
+        pthread_mutex_unlock(&JOB_QUEUE.lock);
+        cJSON_AddStringToObject(root, "error", "Job not found.");
+    } else {
+        static const char *const status[] = { "free", "queued", "running", "done" };
+        long total = __atomic_load_n(&job->progress.total, __ATOMIC_RELAXED);
+        long done = __atomic_load_n(&job->progress.done, __ATOMIC_RELAXED);
+        int percent = job->state == JOB_DONE ? 100 : total > 0 ? (int)(done * 100 / total) : 0;
+        cJSON_AddStringToObject(root, "job_id", job->id);
+        cJSON_AddStringToObject(root, "status", status[job->state]);
+        cJSON_AddNumberToObject(root, "progress", percent);
+        char *result = job->state == JOB_DONE && job->result ? strdup(job->result) : NULL;
+        int rejected = job->state == JOB_DONE && !job->result;
+        pthread_mutex_unlock(&JOB_QUEUE.lock);
+        if (rejected) cJSON_AddStringToObject(root, "error", "Missing or invalid parameters.");
+        if (result) {
+            cJSON *parsed = cJSON_Parse(result);
+            if (parsed) cJSON_AddItemToObject(root, "result", parsed);
+            free(result);
+        }
+    }
+    char *json_string = cJSON_Print(root);
+    cJSON_Delete(root);
+    return json_string;
+}
+
 // --- HTTP Server Implementation (Unchanged) ---
 void parse_request(const char* request, char* method, char* path, char** body) {
     sscanf(request, "%s %s", method, path);
@@ -732,9 +4532,214 @@ void send_error_response(int client_socket, int status_code, const char* message
     write(client_socket, body, strlen(body));
 }
 
+// --- Streaming responses (chunked NDJSON) ---
+static int send_all(int client_socket, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t sent = send(client_socket, data, len, MSG_NOSIGNAL);
+        if (sent <= 0) return 0;
+        data += sent;
+        len -= (size_t)sent;
+    }
+    return 1;
+}
+
+/* Writes one NDJSON line in its own chunk. */
+static int send_ndjson_line(int client_socket, const char *line) {
+    char size[32];
+    size_t len = strlen(line);
+    snprintf(size, sizeof(size), "%zx\r\n", len + 1);
+    return send_all(client_socket, size, strlen(size)) && send_all(client_socket, line, len)
+        && send_all(client_socket, "\n\r\n", 3);
+}
+
+/*
+ * Lines a streaming job has formatted and its connection has not sent yet.
+ * Screening pushes them from the pool workers and the connection thread pops
+ * and sends them, so no worker ever waits on the network. A full queue holds
+ * the pushing workers back until the client catches up; a client that stops
+ * reading trips CLIENT_SEND_TIMEOUT_SEC, which closes the queue and turns
+ * every push into a stop.
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t ready;  /* a line was pushed, or the job finished */
+    pthread_cond_t space;  /* a line was popped, or the queue closed */
+    char *lines[STREAM_QUEUE_LINES];
+    int head, count;
+    int closed;            /* the client is gone; pushes fail */
+    int finished;          /* the job pushes no more lines */
+} StreamQueue;
+
+/* Takes ownership of `line`; 0 once the queue is closed. */
+static int stream_queue_push(StreamQueue *queue, char *line) {
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == STREAM_QUEUE_LINES && !queue->closed) pthread_cond_wait(&queue->space, &queue->lock);
+    int ok = !queue->closed;
+    if (ok) {
+        queue->lines[(queue->head + queue->count++) % STREAM_QUEUE_LINES] = line;
+        pthread_cond_signal(&queue->ready);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    if (!ok) free(line);
+    return ok;
+}
+
+/* The next line, to be freed by the caller, or NULL once the job has finished and every line is popped. */
+static char *stream_queue_pop(StreamQueue *queue) {
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == 0 && !queue->finished) pthread_cond_wait(&queue->ready, &queue->lock);
+    char *line = NULL;
+    if (queue->count > 0) {
+        line = queue->lines[queue->head];
+        queue->head = (queue->head + 1) % STREAM_QUEUE_LINES;
+        queue->count--;
+        pthread_cond_broadcast(&queue->space);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return line;
+}
+
+static void stream_queue_close(StreamQueue *queue) {
+    pthread_mutex_lock(&queue->lock);
+    queue->closed = 1;
+    pthread_cond_broadcast(&queue->space);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+static void stream_queue_finish(StreamQueue *queue) {
+    pthread_mutex_lock(&queue->lock);
+    queue->finished = 1;
+    pthread_cond_broadcast(&queue->ready);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+typedef struct {
+    StreamQueue *queue;
+    const ScreenParams *params;
+} PredictStream;
+
+static int predict_stream_emit(void *ctx, const Conjunction *c) {
+    PredictStream *stream = ctx;
+    if (c->min_dist <= MIN_DIST_KM) return 1;
+    cJSON *event = predict_event_json(c, stream->params);
+    char *line = cJSON_PrintUnformatted(event);
+    cJSON_Delete(event);
+    return line && stream_queue_push(stream->queue, line);
+}
+
+/*
+ * Job side of a streaming /predict: pushes every event to the StreamQueue in
+ * `arg` as soon as it is final and returns the last line, which carries
+ * "done" and the screening stats. In refine mode that is the moment each
+ * approach is refined, so a pair appears once per approach rather than once
+ * overall, and events go straight to the queue without being collected.
+ * Sampled screening only knows a pair's minimum after the sweep, so it
+ * collects its pair set and its events follow the sweep, as do top_k
+ * results, closest first.
+ */
+static char *predict_stream_job(const Catalog *catalog, const cJSON *json, User *user, ScreenProgress *progress, void *arg) {
+    (void)user;
+    StreamQueue *queue = arg;
+    ScreenParams params;
+    if (!parse_predict_params(catalog, json, &params)) {
+        stream_queue_finish(queue);
+        return NULL;
+    }
+    params.progress = progress;
+    PredictStream stream = { queue, &params };
+    ApproachSink sink = { predict_stream_emit, &stream };
+    SieveStats stats = {0};
+    int ok = 1, cached = 0;
+    size_t first;
+    double lo;
+    ConjunctionTable *table = params.refine && !params.top_k && params.model == MODEL_SGP4
+                              && params.exclude == EXCLUDE_CONSTELLATION
+        ? conjunction_cache_acquire(catalog, params.start_time, params.duration_sec, params.threshold_km, &first, &lo) : NULL;
+    if (table) {
+        cached = 1;
+        for (size_t k = first; ok && k < table->count && table->approaches[k].min_time <= lo + params.duration_sec; ++k) {
+            Conjunction c = table->approaches[k];
+            if (c.min_dist >= params.threshold_km) continue;
+            c.min_time -= lo;
+            ok = predict_stream_emit(&stream, &c);
+        }
+        stats = table->stats;
+        conjunction_cache_release(table);
+    } else {
+        ConjunctionSet set;
+        params.sink = params.refine && !params.top_k ? &sink : NULL;
+        ok = conjunction_set_init(&set, 1024);
+        if (ok) {
+            ok = screen_catalog(&params, &set, &stats);
+            size_t found = 0;
+            Conjunction *conj = ok && !params.sink ? conjunction_set_sorted(&set, &found) : NULL;
+            if (params.top_k) qsort(conj, found, sizeof(Conjunction), compare_conjunction_distances);
+            for (size_t k = 0; ok && k < found; ++k) ok = predict_stream_emit(&stream, &conj[k]);
+            conjunction_set_free(&set);
+        }
+    }
+    stream_queue_finish(queue);
+    cJSON *tail = cJSON_CreateObject();
+    if (ok) {
+        cJSON_AddBoolToObject(tail, "done", 1);
+        cJSON_AddBoolToObject(tail, "cached", cached);
+        add_screening_stats(tail, &stats);
+    } else {
+        cJSON_AddStringToObject(tail, "error", "Out of memory.");
+    }
+    char *line = cJSON_PrintUnformatted(tail);
+    cJSON_Delete(tail);
+    return line;
+}
+
+/*
+ * /predict with "stream": true. Events are sent as NDJSON over chunked
+ * transfer encoding. The screening runs as a job like any other and hands
+ * its events over through a StreamQueue; this thread only sends them, and
+ * a client that stops reading stops the screening. Returns an error body if
+ * nothing was sent yet, otherwise NULL.
+ */
+char* handle_predict_stream(const Catalog* catalog, int client_socket, const cJSON* json, User* user) {
+    if (!is_pro_user(user)) { return strdup("{\"error\":\"This is a Pro feature. Please upgrade your plan.\"}"); }
+    ScreenParams params;
+    if (!parse_predict_params(catalog, json, &params)) return NULL;
+    if (JOB_QUEUE.runners == 0) return strdup("{\"error\":\"Streaming is unavailable.\"}");
+
+    StreamQueue queue = {
+        .lock = PTHREAD_MUTEX_INITIALIZER, .ready = PTHREAD_COND_INITIALIZER, .space = PTHREAD_COND_INITIALIZER,
+    };
+    char *error = NULL;
+    Job *job = job_queue_submit(json, user, predict_stream_job, &queue, 1, &error);
+    if (!job) return error;
+    const char *headers = "HTTP/1.1 200 OK\r\n"
+                          "Content-Type: application/x-ndjson\r\n"
+                          "Access-Control-Allow-Origin: *\r\n"
+                          "Transfer-Encoding: chunked\r\n"
+                          "\r\n";
+    int ok = send_all(client_socket, headers, strlen(headers));
+    if (!ok) stream_queue_close(&queue);
+    /* After the client is gone, keep popping so the job sees the closed queue and stops. */
+    char *line;
+    while ((line = stream_queue_pop(&queue))) {
+        if (ok && !(ok = send_ndjson_line(client_socket, line))) stream_queue_close(&queue);
+        free(line);
+    }
+    char *tail = job_queue_wait(job);
+    if (ok && send_ndjson_line(client_socket, tail ? tail : "{\"error\":\"Missing or invalid parameters.\"}")) {
+        send_all(client_socket, "0\r\n\r\n", 5);
+    }
+    free(tail);
+    pthread_cond_destroy(&queue.ready);
+    pthread_cond_destroy(&queue.space);
+    pthread_mutex_destroy(&queue.lock);
+    return NULL;
+}
+
 void *handle_connection(void *socket_desc) {
     int sock = *(int*)socket_desc;
     free(socket_desc);
+    struct timeval send_timeout = { CLIENT_SEND_TIMEOUT_SEC, 0 };
+    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &send_timeout, sizeof(send_timeout));
     char buffer[BUFFER_SIZE] = {0};
 
     read(sock, buffer, BUFFER_SIZE - 1);
@@ -753,6 +4758,7 @@ void *handle_connection(void *socket_desc) {
         if (!json_body) {
             send_error_response(sock, 400, "Invalid JSON");
         } else {
+            Catalog *catalog = catalog_acquire();
             if (strcmp(path, "/signup") == 0) response_body = handle_signup(json_body);
             else if (strcmp(path, "/login") == 0) response_body = handle_login(json_body);
             else {
@@ -760,12 +4766,15 @@ void *handle_connection(void *socket_desc) {
                 if (!user) {
                     send_error_response(sock, 401, "Authentication failed.");
                 } else {
-                    if (strcmp(path, "/list") == 0) response_body = handle_list_sats();
-                    else if (strcmp(path, "/filter") == 0) response_body = handle_filter_sats(json_body);
-                    else if (strcmp(path, "/risk") == 0) response_body = handle_risk_check(json_body);
-                    else if (strcmp(path, "/details") == 0) response_body = handle_details(json_body);
-                    else if (strcmp(path, "/predict") == 0) response_body = handle_predict_collisions(json_body, user);
-                    else if (strcmp(path, "/plan") == 0) response_body = handle_safe_path(json_body, user);
+                    if (strcmp(path, "/list") == 0) response_body = handle_list_sats(catalog);
+                    else if (strcmp(path, "/filter") == 0) response_body = handle_filter_sats(catalog, json_body);
+                    else if (strcmp(path, "/risk") == 0) response_body = handle_risk_check(catalog, json_body);
+                    else if (strcmp(path, "/details") == 0) response_body = handle_details(catalog, json_body);
+                    else if (strcmp(path, "/predict") == 0 && cJSON_IsTrue(cJSON_GetObjectItem(json_body, "stream"))) response_body = handle_predict_stream(catalog, sock, json_body, user);
+                    else if (strcmp(path, "/predict") == 0) response_body = handle_screening_request(catalog, json_body, user, handle_predict_collisions);
+                    else if (strcmp(path, "/screen") == 0) response_body = handle_screening_request(catalog, json_body, user, handle_screen_primaries);
+                    else if (strncmp(path, "/jobs/", 6) == 0) response_body = handle_job_status(path + 6, user);
+                    else if (strcmp(path, "/plan") == 0) response_body = handle_safe_path(catalog, json_body, user);
                     else if (strcmp(path, "/upgrade") == 0) response_body = handle_upgrade(user);
                     else if (strcmp(path, "/generate-key") == 0) {
                         if (is_pro_user(user)) {
@@ -778,6 +4787,7 @@ void *handle_connection(void *socket_desc) {
                     }
                 }
             }
+            catalog_release(catalog);
 
             if (response_body) {
                 if (response_body == NULL) {
@@ -799,39 +4809,67 @@ int main(void) {
     srand(time(NULL));
     load_users_db();
     printf("Loaded %d users from %s\n", USERS_COUNT, USERS_DB_FILE);
-
-    // --- TLE Data ---
-    const char *live_tle_url = "https://celestrak.org/NORAD/elements/gp.php?GROUP=active&FORMAT=tle";
-    const char *tle_filename = "tle_data.txt";
-    printf("Downloading latest satellite TLE data...\n");
-    if (!download_tle_file(live_tle_url, tle_filename)) {
-        fprintf(stderr, "Failed to download live TLE data. Using local cache if available.\n");
+    /* Started first: catalog loads parse on the pool too. */
+    if (!worker_pool_start(&SCREEN_POOL, SCREEN_THREADS)) {
+        fprintf(stderr, "Could not start screening workers; loading and screening will run on the calling thread.\n");
     } else {
-        printf("Live TLE data downloaded successfully.\n");
-    }
-    printf("Loading satellite TLE data from '%s'...\n", tle_filename);
-    SATS_COUNT = load_tle_file(tle_filename, SATS_DB, MAX_SATS);
-    if (SATS_COUNT < 0) {
-        fprintf(stderr, "Error: could not open '%s'. Exiting.\n", tle_filename);
-        return 1;
+        printf("Started %d screening worker threads.\n", SCREEN_POOL.size);
     }
-    printf("Loaded %d satellite TLE entries.\n", SATS_COUNT);
 
-    // --- NEW: SATCAT Data ---
+    // --- Catalog ---
+    const char *live_tle_url = "https://celestrak.org/NORAD/elements/gp.php?GROUP=active&FORMAT=tle";
+    const char *tle_filename = "tle_data.txt";
     const char *live_satcat_url = "https://celestrak.org/pub/satcat.txt";
     const char *satcat_filename = "sat_data.txt";
-    printf("Downloading latest SATCAT data...\n");
-    if (!download_tle_file(live_satcat_url, satcat_filename)) {
-        fprintf(stderr, "Failed to download live SATCAT data. Using local cache if available.\n");
-    } else {
-        printf("Live SATCAT data downloaded successfully.\n");
-    }
-    printf("Loading satellite catalog data from '%s'...\n", satcat_filename);
-    SATCAT_COUNT = load_satcat_file(satcat_filename, SATCAT_DB, MAX_SATS);
-    if (SATCAT_COUNT < 0) {
-        fprintf(stderr, "Error: could not open '%s'. Details will not be available.\n", satcat_filename);
+    /* A current snapshot skips the downloads and the parse; the catalog keeper refreshes the TLEs and SATCAT right away. */
+    Catalog *catalog = catalog_snapshot_load(CATALOG_SNAPSHOT, tle_filename, satcat_filename);
+    int from_snapshot = catalog != NULL;
+    if (from_snapshot) {
+        printf("Loaded %d satellites and %d SATCAT entries from snapshot '%s'. Server is ready.\n",
+               catalog->count, catalog->satcat_count, CATALOG_SNAPSHOT);
+        catalog_publish(catalog);
     } else {
-        printf("Loaded %d SATCAT entries. Server is ready.\n", SATCAT_COUNT);
+        catalog = catalog_alloc(1);
+        if (!catalog) {
+            fprintf(stderr, "Error: out of memory. Exiting.\n");
+            return 1;
+        }
+        int capacity = 0;
+        // --- TLE Data ---
+        printf("Downloading latest satellite TLE data...\n");
+        if (!download_tle_file(live_tle_url, tle_filename)) {
+            fprintf(stderr, "Failed to download live TLE data. Using local cache if available.\n");
+        } else {
+            printf("Live TLE data downloaded successfully.\n");
+        }
+        printf("Loading satellite TLE data from '%s'...\n", tle_filename);
+        catalog->count = load_tle_file(tle_filename, &catalog->sats, &capacity);
+        if (catalog->count < 0) {
+            fprintf(stderr, "Error: could not open '%s'. Exiting.\n", tle_filename);
+            return 1;
+        }
+        printf("Loaded %d satellite TLE entries.\n", catalog->count);
+
+        // --- NEW: SATCAT Data ---
+        printf("Downloading latest SATCAT data...\n");
+        if (!download_tle_file(live_satcat_url, satcat_filename)) {
+            fprintf(stderr, "Failed to download live SATCAT data. Using local cache if available.\n");
+        } else {
+            printf("Live SATCAT data downloaded successfully.\n");
+        }
+        printf("Loading satellite catalog data from '%s'...\n", satcat_filename);
+        capacity = 0;
+        catalog->satcat_count = load_satcat_file(satcat_filename, &catalog->satcat, &capacity);
+        if (catalog->satcat_count < 0) {
+            catalog->satcat_count = 0;
+            fprintf(stderr, "Error: could not open '%s'. Details will not be available.\n", satcat_filename);
+        } else {
+            printf("Loaded %d SATCAT entries. Server is ready.\n", catalog->satcat_count);
+        }
+        catalog_publish(catalog);
+        if (!catalog_snapshot_save(CATALOG_SNAPSHOT)) {
+            fprintf(stderr, "Could not write the catalog snapshot '%s'.\n", CATALOG_SNAPSHOT);
+        }
     }
 
 
@@ -855,6 +4893,18 @@ int main(void) {
     if (listen(server_fd, 10) < 0) {
         perror("listen"); exit(EXIT_FAILURE);
     }
+    if (!job_runners_start(JOB_RUNNERS)) {
+        fprintf(stderr, "Could not start job runners; screening will run on each connection and async requests will be refused.\n");
+    }
+    conjunction_cache_start();
+    static CatalogSource source;
+    source = (CatalogSource){ live_tle_url, tle_filename, live_satcat_url, satcat_filename, from_snapshot };
+    pthread_t catalog_thread;
+    if (pthread_create(&catalog_thread, NULL, catalog_keeper, &source) != 0) {
+        fprintf(stderr, "Could not start the catalog refresh; the catalog will not update.\n");
+    } else {
+        pthread_detach(catalog_thread);
+    }
     printf("\nMulti-threaded server with Auth listening on port 8080...\n");
     
     while(1) {
@@ -0,0 +1,77 @@
+/*
+ * Propagates every object of a catalog through a fixed window and checks it
+ * against the bounds screening relies on: the radius stays inside the
+ * sieve's apsis shell, and speed and acceleration stay under motion_bounds.
+ * A bound that does not hold lets the sieve or the sweep skip a real
+ * conjunction. Prints each violation and exits 1 if there is any.
+ *
+ *   bounds_check <tle file> <j2|kepler> <duration days>
+ */
+#define main server_main
+#include "../server.c"
+#undef main
+
+#define CHECK_START_TIME 1759400000.0 /* same window as screen_check */
+#define CHECK_STEP_SEC 30.0
+#define CHECK_TOL 1e-9            /* relative slack for rounding */
+
+int main(int argc, char **argv) {
+    if (argc != 4) {
+        fprintf(stderr, "usage: %s <tle file> <j2|kepler> <duration days>\n", argv[0]);
+        return 2;
+    }
+    cJSON *request = cJSON_CreateObject();
+    cJSON_AddStringToObject(request, "model", argv[2]);
+    PropagationModel model;
+    int valid = parse_model(request, &model);
+    cJSON_Delete(request);
+    if (!valid || model == MODEL_SGP4) {
+        fprintf(stderr, "Model must be j2 or kepler.\n");
+        return 2;
+    }
+    Satellite *sats = NULL;
+    int capacity = 0;
+    int count = load_tle_file(argv[1], &sats, &capacity);
+    if (count < 0) {
+        fprintf(stderr, "Could not read '%s'.\n", argv[1]);
+        return 2;
+    }
+    /* The bounds are for the model itself, which the sweep's batch solve follows, not its Chebyshev fit. */
+    for (int i = 0; i < count; ++i) sats[i].ephemeris = &EPHEMERIS_NONE;
+    double t0 = CHECK_START_TIME, t1 = t0 + atol(argv[3]) * 86400.0;
+    int checked = 0, violations = 0;
+    double worst_km = 0;
+    for (int i = 0; i < count; ++i) {
+        const Satellite *sat = &sats[i];
+        if (!sat->valid) continue;
+        SieveOrbit orbit;
+        double speed_max, accel_max;
+        sieve_orbit_init(sat, &orbit, t0, t1, model);
+        motion_bounds(sat, model, t0, t1, &speed_max, &accel_max);
+        double rmin = INFINITY, rmax = 0, speed = 0, accel = 0;
+        for (double t = t0; t <= t1; t += CHECK_STEP_SEC) {
+            double r[3], v[3], r_before[3], v_before[3], r_after[3], v_after[3];
+            propagate_state(sat, model, t, r, v);
+            propagate_state(sat, model, t - 0.5, r_before, v_before);
+            propagate_state(sat, model, t + 0.5, r_after, v_after);
+            double radius = sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]);
+            double dv[3] = { v_after[0] - v_before[0], v_after[1] - v_before[1], v_after[2] - v_before[2] };
+            rmin = fmin(rmin, radius);
+            rmax = fmax(rmax, radius);
+            speed = fmax(speed, sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]));
+            accel = fmax(accel, sqrt(dv[0] * dv[0] + dv[1] * dv[1] + dv[2] * dv[2]));
+        }
+        checked++;
+        double outside = fmax(orbit.rp - rmin, rmax - orbit.ra);
+        worst_km = fmax(worst_km, outside);
+        int bad = outside > CHECK_TOL * orbit.ra || speed > speed_max * (1.0 + CHECK_TOL)
+               || accel > accel_max * (1.0 + 1e-6); /* the central difference is good to about 1e-8 */
+        if (bad && violations++ < 20) {
+            printf("  %d %s: radius %.3f-%.3f km, shell %.3f-%.3f km; speed %.6f of %.6f km/s; accel %.3e of %.3e km/s^2\n",
+                   sat->norad_id, sat->name, rmin, rmax, orbit.rp, orbit.ra, speed, speed_max, accel, accel_max);
+        }
+    }
+    fprintf(stderr, "%d objects checked, %d outside their bounds, worst %.3f km outside the shell.\n", checked,
+            violations, worst_km);
+    return violations > 0;
+}
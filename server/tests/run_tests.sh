@@ -0,0 +1,164 @@
+#!/bin/sh
+# Checks the TLE loader with tle_check, the catalog snapshot with
+# snapshot_check, SGP4 with sgp4_check and the bounds screening relies on
+# with bounds_check, then builds screen_check in pairs of variants and checks
+# that each pair finds the same conjunctions. Run from anywhere; needs gcc,
+# libcurl and awk.
+set -e
+here=$(cd "$(dirname "$0")" && pwd)
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+# The first 1,000 objects of the bundled catalog keep a run to seconds.
+head -n 3000 "$here/../tle_data.txt" > "$work/tle.txt"
+failed=0
+
+build() { # name, extra flags, source
+    gcc -O2 -march=native $2 -o "$work/$1" "$here/${3:-screen_check.c}" "$here/../cJSON.c" -lcurl -lm -lpthread
+}
+
+# Same pairs, then miss distance within $3 km and TCA within $4 s.
+compare() { # label, reference output, checked output, km, seconds
+    if awk -v km="$4" -v sec="$5" '
+        function abs(x) { return x < 0 ? -x : x }
+        NR == FNR { ref[$1 " " $2] = $3 " " $4; next }
+        {
+            key = $1 " " $2
+            if (!(key in ref)) { print "  extra pair " key " at " $3 " km"; bad = 1; next }
+            split(ref[key], r, " ")
+            if (abs($3 - r[1]) > km || abs($4 - r[2]) > sec) { print "  pair " key ": " $3 " km at " $4 " s, expected " r[1] " km at " r[2] " s"; bad = 1 }
+            delete ref[key]
+        }
+        END {
+            for (key in ref) { split(ref[key], r, " "); print "  missing pair " key " at " r[1] " km"; bad = 1 }
+            exit bad
+        }' "$2" "$3"; then
+        echo "PASS $1 ($(wc -l < "$2") pairs)"
+    else
+        echo "FAIL $1"
+        failed=1
+    fi
+}
+
+# The mapped loader against the fgets and atof one it replaced, on the whole
+# bundled catalog and on a copy with CRLF endings, blank lines and no final
+# newline.
+build tle "" tle_check.c
+sed 's/$/\r/' "$here/../tle_data.txt" | awk 'NR % 300 == 1 { print "" } { print }' | head -c -2 > "$work/tle_crlf.txt"
+for file in "$here/../tle_data.txt" "$work/tle_crlf.txt"; do
+    if "$work/tle" "$file"; then
+        echo "PASS tle loader, $(basename "$file")"
+    else
+        echo "FAIL tle loader, $(basename "$file")"
+        failed=1
+    fi
+done
+
+# A snapshot must load back as the catalog it was saved from, and be refused
+# when cut short, from another build or older than the text. The SATCAT
+# records are made up from the TLE names.
+build snapshot "" snapshot_check.c
+cp "$work/tle.txt" "$work/tle_snapshot.txt"
+awk 'NR % 3 == 2 { id = substr($0, 3, 5) + 0
+                   printf "%-13s%05d%-5s%-25s %-5s%-10s%-10s%-9s%-17s\n", "1958-002B", id, "", "OBJECT " id, "US", "",
+                          "1958-03-17", "", (id % 7 ? "" : "2001-01-01") }' "$work/tle.txt" > "$work/satcat.txt"
+if "$work/snapshot" "$work/tle_snapshot.txt" "$work/satcat.txt" "$work/catalog.snap"; then
+    echo "PASS snapshot round trip and refusals"
+else
+    echo "FAIL snapshot round trip and refusals"
+    failed=1
+fi
+
+# SGP4 against Vallado's published vectors, and the SIMD batch against it.
+build sgp4 "" sgp4_check.c
+if "$work/sgp4"; then
+    echo "PASS sgp4 vectors and batch"
+else
+    echo "FAIL sgp4 vectors and batch"
+    failed=1
+fi
+
+build bounds "" bounds_check.c
+for model in j2 kepler; do
+    if "$work/bounds" "$work/tle.txt" $model 1; then
+        echo "PASS bounds, $model"
+    else
+        echo "FAIL bounds, $model"
+        failed=1
+    fi
+done
+
+# The sieve is conservative: dropping objects it rules out must not lose a
+# conjunction the full sweep finds.
+build sieve_on "-DSCREEN_SIEVE=1"
+build sieve_off "-DSCREEN_SIEVE=0"
+for model in j2 sgp4; do
+    "$work/sieve_off" "$work/tle.txt" $model 10 1 > "$work/off_$model.txt"
+    "$work/sieve_on" "$work/tle.txt" $model 10 1 > "$work/on_$model.txt"
+    compare "sieve, $model" "$work/off_$model.txt" "$work/on_$model.txt" 0.000001 0.001
+done
+
+# The float32 coarse pass only proposes candidates that double precision
+# confirms, so it must find the same pairs as the double-only sweep, refined
+# or sampled, including those close to the threshold.
+build coarse_float "-DSCREEN_COARSE_FLOAT=1"
+build coarse_double "-DSCREEN_COARSE_FLOAT=0"
+for run in "sgp4 5 1" "sgp4 20 1" "j2 20 1" "sgp4 20 1 5"; do
+    name=$(echo "$run" | tr ' ' _)
+    "$work/coarse_double" "$work/tle.txt" $run > "$work/double_$name.txt"
+    "$work/coarse_float" "$work/tle.txt" $run > "$work/float_$name.txt"
+    compare "coarse float, $run" "$work/double_$name.txt" "$work/float_$name.txt" 0.000001 0.001
+done
+
+# top_k shares the tightest k-th distance between workers and prunes pair
+# tests and refinements with it, so with several workers it must still keep
+# exactly the k closest pairs of the full screen. The full screen also lists
+# pairs the top_k path drops as duplicates (MIN_DIST_KM, 10 m), so those are
+# left out of the reference.
+build top_k "-DSCREEN_THREADS=4"
+for run in "sgp4 50 1" "sgp4 50 1 5"; do
+    name=$(echo "$run" | tr ' ' _)
+    "$work/top_k" "$work/tle.txt" $run | awk '$3 > 0.01' | sort -g -k3 > "$work/full_$name.txt"
+    for k in 20 100; do
+        head -n $k "$work/full_$name.txt" > "$work/first_$name.txt"
+        "$work/top_k" -k $k "$work/tle.txt" $run > "$work/top_$name.txt"
+        compare "top_k $k against the full screen, $run" "$work/first_$name.txt" "$work/top_$name.txt" 0.000001 0.001
+    done
+done
+
+# A table rolled forward must hold what a full screen of its new window finds.
+build cache "-DCACHE_HORIZON_DAYS=1"
+for roll in 21600 37230; do
+    "$work/cache" -r "$work/tle.txt" $roll | grep -v '^Conjunction cache:' > "$work/rolled_$roll.txt"
+    "$work/cache" -c "$work/tle.txt" $roll $((roll + 86400)) > "$work/rebuilt_$roll.txt"
+    compare "cache rolled ${roll}s against a rebuild" "$work/rebuilt_$roll.txt" "$work/rolled_$roll.txt" 0.000001 0.001
+done
+
+# A table rescreened after an update must hold what a full screen of the
+# updated catalog finds over the rest of the window. The update moves every
+# 20th object half a degree along its orbit and adds a near twin of one.
+awk 'function shift(line, by) { m = substr(line, 44, 8) + by; if (m >= 360) m -= 360; return substr(line, 1, 43) sprintf("%8.4f", m) substr(line, 52) }
+     NR % 3 == 0 && (NR / 3) % 20 == 0 { $0 = shift($0, 0.5) }
+     { print }
+     NR >= 118 && NR <= 120 { copy[NR - 117] = $0 }
+     END { print "TWIN"; print "1 99999" substr(copy[2], 8); print "2 99999" substr(shift(copy[3], 0.01), 8) }' \
+    "$work/tle.txt" > "$work/tle_update.txt"
+for at in 0 21600; do
+    "$work/cache" -u "$work/tle.txt" "$work/tle_update.txt" $at | grep -v '^Conjunction cache:' > "$work/rescreened_$at.txt"
+    "$work/cache" -c "$work/tle_update.txt" $at 86400 > "$work/rebuilt_update_$at.txt"
+    compare "cache rescreened at ${at}s against a rebuild" "$work/rebuilt_update_$at.txt" "$work/rescreened_$at.txt" 0.000001 0.001
+done
+
+# Sampled screening keeps a pair on its closest sample alone, so put the
+# threshold a millimetre above each pair's miss distance: a float rounding
+# that dropped that sample would lose the pair.
+head -n 8 "$work/double_sgp4_20_1_5.txt" | {
+while read -r id1 id2 km seconds; do
+    threshold=$(awk -v km="$km" 'BEGIN { printf "%.6f", km + 0.000001 }')
+    "$work/coarse_double" "$work/tle.txt" sgp4 "$threshold" 1 5 > "$work/edge_double.txt"
+    "$work/coarse_float" "$work/tle.txt" sgp4 "$threshold" 1 5 > "$work/edge_float.txt"
+    compare "coarse float at the threshold of $id1-$id2, $threshold km" "$work/edge_double.txt" "$work/edge_float.txt" 0.000001 0.001
+done
+exit $failed
+} || failed=1
+
+exit $failed
@@ -0,0 +1,170 @@
+/*
+ * Screens a fixed catalog over a fixed window and prints each pair's closest
+ * approach, one "norad1 norad2 km seconds" line per pair in catalog order:
+ * refined by default, or sampled every `step` minutes. With -k only the
+ * top_k closest pairs are kept, printed closest first as /predict lists
+ * them. run_tests.sh builds it with different tunables and compares the
+ * outputs.
+ *
+ * The cache modes print a conjunction cache table instead, SGP4 under
+ * CACHE_THRESHOLD_KM, one "norad1 norad2/n km seconds" line per approach:
+ * the n-th approach of that pair, seconds from the start of the fixed
+ * window. -c screens [start, end] from scratch; -r builds the table over
+ * CACHE_HORIZON_DAYS and rolls it forward to `roll`; -u builds it, applies
+ * the catalog in `update` with catalog_update and rescreens the changed
+ * objects from `at`. Approaches clipped at the table's start are left out:
+ * a roll or rescreen drops them as past by design.
+ *
+ *   screen_check [-k top_k] <tle file> <sgp4|j2|kepler> <threshold km> <duration days> [step minutes]
+ *   screen_check -c <tle file> <start seconds> <end seconds>
+ *   screen_check -r <tle file> <roll seconds>
+ *   screen_check -u <tle file> <update tle file> <at seconds>
+ */
+#define main server_main
+#include "../server.c"
+#undef main
+
+#define CHECK_START_TIME 1759400000.0 /* 2025-10-02, within a few days of the bundled elements */
+
+static void print_approaches(const Satellite *sats, const Conjunction *approaches, size_t count, double offset) {
+    for (size_t k = 0; k < count; ++k) {
+        const Conjunction *c = &approaches[k];
+        if (c->min_time <= 0) continue;
+        int n = 1;
+        for (size_t e = 0; e < k; ++e) n += approaches[e].i == c->i && approaches[e].j == c->j && approaches[e].min_time > 0;
+        printf("%d %d/%d %.6f %.3f\n", sats[c->i].norad_id, sats[c->j].norad_id, n, c->min_dist, offset + c->min_time);
+    }
+}
+
+/* Publishes the catalog in `filename` as the server's current one; 0 when it cannot be read. */
+static int publish_catalog(const char *filename) {
+    Catalog *catalog = catalog_alloc(1);
+    int capacity = 0;
+    if (!catalog || (catalog->count = load_tle_file(filename, &catalog->sats, &capacity)) < 0) return 0;
+    catalog->satcat = malloc(sizeof(SatCatData));
+    catalog_publish(catalog);
+    return catalog->satcat != NULL;
+}
+
+static int cache_main(int argc, char **argv) {
+    char mode = argv[1][1];
+    if ((mode == 'c' && argc != 5) || (mode == 'r' && argc != 4) || (mode == 'u' && argc != 5)) {
+        fprintf(stderr, "usage: %s -c <tle file> <start seconds> <end seconds>\n"
+                        "       %s -r <tle file> <roll seconds>\n"
+                        "       %s -u <tle file> <update tle file> <at seconds>\n", argv[0], argv[0], argv[0]);
+        return 2;
+    }
+    worker_pool_start(&SCREEN_POOL, SCREEN_THREADS);
+    if (!publish_catalog(argv[2])) {
+        fprintf(stderr, "Could not read '%s'.\n", argv[2]);
+        return 2;
+    }
+    long at = atol(argv[mode == 'u' ? 4 : 3]);
+    Catalog *catalog = catalog_acquire();
+    if (mode == 'c') {
+        ApproachList list = {0};
+        SieveStats stats = {0};
+        if (!conjunction_cache_screen(catalog, CHECK_START_TIME + at, atol(argv[4]) - at, NULL, &list, &stats)) {
+            fprintf(stderr, "Out of memory.\n");
+            return 1;
+        }
+        qsort(list.items, list.count, sizeof(Conjunction), compare_approach_times);
+        print_approaches(catalog->sats, list.items, list.count, at);
+        approach_list_free(&list);
+        catalog_release(catalog);
+        return 0;
+    }
+    ConjunctionTable *table = conjunction_table_build(catalog, CHECK_START_TIME);
+    catalog_release(catalog);
+    CONJ_CACHE.building = 1;
+    conjunction_cache_install(table);
+    if (mode == 'r' && (!table || !conjunction_cache_roll(CHECK_START_TIME + at))) {
+        fprintf(stderr, "Could not build and roll the table.\n");
+        return 1;
+    }
+    if (mode == 'u') {
+        char *changed;
+        if (!table || catalog_update(argv[3], NULL, &changed) < 0) {
+            fprintf(stderr, "Could not build the table or apply '%s'.\n", argv[3]);
+            return 1;
+        }
+        catalog = catalog_acquire();
+        int ok = conjunction_cache_rescreen(catalog, changed, CHECK_START_TIME + at);
+        catalog_release(catalog);
+        free(changed);
+        if (!ok) {
+            fprintf(stderr, "Could not rescreen the table.\n");
+            return 1;
+        }
+    }
+    catalog = catalog_acquire();
+    table = CONJ_CACHE.table;
+    print_approaches(catalog->sats, table->approaches, table->count, table->start_time - CHECK_START_TIME);
+    catalog_release(catalog);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    const char *program = argv[0];
+    if (argc > 1 && (strcmp(argv[1], "-c") == 0 || strcmp(argv[1], "-r") == 0 || strcmp(argv[1], "-u") == 0)) {
+        return cache_main(argc, argv);
+    }
+    int top_k = 0;
+    if (argc > 2 && strcmp(argv[1], "-k") == 0) {
+        top_k = atoi(argv[2]);
+        argc -= 2;
+        argv += 2;
+    }
+    if ((argc != 5 && argc != 6) || top_k < 0) {
+        fprintf(stderr, "usage: %s [-k top_k] <tle file> <sgp4|j2|kepler> <threshold km> <duration days> [step minutes]\n",
+                program);
+        return 2;
+    }
+    cJSON *request = cJSON_CreateObject();
+    cJSON_AddStringToObject(request, "model", argv[2]);
+    PropagationModel model;
+    int valid = parse_model(request, &model);
+    cJSON_Delete(request);
+    if (!valid) {
+        fprintf(stderr, "Unknown model '%s'.\n", argv[2]);
+        return 2;
+    }
+    worker_pool_start(&SCREEN_POOL, SCREEN_THREADS);
+    Satellite *sats = NULL;
+    int capacity = 0;
+    int count = load_tle_file(argv[1], &sats, &capacity);
+    if (count < 0) {
+        fprintf(stderr, "Could not read '%s'.\n", argv[1]);
+        return 2;
+    }
+
+    ScreenParams params = {
+        .sats = sats,
+        .count = count,
+        .start_time = CHECK_START_TIME,
+        .duration_sec = atol(argv[4]) * 86400L,
+        .step_sec = argc == 6 ? atol(argv[5]) * 60L : REFINE_STEP_SEC,
+        .threshold_km = atof(argv[3]),
+        .refine = argc == 5,
+        .top_k = top_k,
+        .model = model,
+        .exclude = EXCLUDE_NONE,
+    };
+    ConjunctionSet set;
+    SieveStats stats = {0};
+    if (!conjunction_set_init(&set, 1024) || !screen_catalog(&params, &set, &stats)) {
+        fprintf(stderr, "Out of memory.\n");
+        return 1;
+    }
+    size_t found = 0;
+    Conjunction *conj = conjunction_set_sorted(&set, &found);
+    if (top_k) qsort(conj, found, sizeof(Conjunction), compare_conjunction_distances);
+    for (size_t k = 0; k < found; ++k) {
+        printf("%d %d %.6f %.3f\n", sats[conj[k].i].norad_id, sats[conj[k].j].norad_id, conj[k].min_dist,
+               conj[k].min_time);
+    }
+    fprintf(stderr, "%d objects, %zu pairs, %lld of %lld pairs passed the sieve.\n", count, found, stats.passed,
+            stats.pairs);
+    conjunction_set_free(&set);
+    return 0;
+}
@@ -0,0 +1,125 @@
+/*
+ * Checks the native SGP4 against the verification vectors Vallado et al.
+ * publish with "Revisiting Spacetrack Report #3" (tcppver.out), for two
+ * near-Earth cases: 00005, eccentric, and 06251, with drag. Then checks that
+ * propagate_batch, the SIMD kernel the sweep uses, matches sgp4_state for
+ * the same objects over a day. Prints each mismatch and exits 1 if there is
+ * any.
+ *
+ *   sgp4_check
+ */
+#define main server_main
+#include "../server.c"
+#undef main
+
+#define CHECK_POS_KM 1e-6      /* published to 1e-8 km; allow for rounding in the constants */
+#define CHECK_VEL_KMS 1e-9     /* published to 1e-9 km/s */
+#define CHECK_BATCH_KM 1e-6    /* batch against scalar, over a day */
+#define CHECK_BATCH_KMS 1e-9
+
+typedef struct {
+    const char *line1, *line2;
+    int count;
+    double rows[13][7]; /* minutes since epoch, r (km), v (km/s) */
+} Vectors;
+
+static const Vectors CASES[] = {
+    { "1 00005U 58002B   00179.78495062  .00000023  00000-0  28098-4 0  4753",
+      "2 00005  34.2682 348.7242 1859667 331.7664  19.3264 10.82419157413667",
+      13,
+      { {    0.0,  7022.46529266, -1400.08296755,     0.03995155,  1.893841015,  6.405893759,  4.534807250 },
+        {  360.0, -7154.03120202, -3783.17682504, -3536.19412294,  4.741887409, -4.151817765, -2.093935425 },
+        {  720.0, -7134.59340119,  6531.68641334,  3260.27186483, -4.113793027, -2.911922039, -2.557327851 },
+        { 1080.0,  5568.53901181,  4492.06992591,  3863.87641983, -4.209106476,  5.159719888,  2.744852980 },
+        { 1440.0,  -938.55923943, -6268.18748831, -4294.02924751,  7.536105209, -0.427127707,  0.989878080 },
+        { 1800.0, -9680.56121728,  2802.47771354,   124.10688038, -0.905874102, -4.659467970, -3.227347517 },
+        { 2160.0,   190.19796988,  7746.96653614,  5110.00675412, -6.112325142,  1.527008184, -0.139152358 },
+        { 2520.0,  5579.55640116, -3995.61396789, -1518.82108966,  4.767927483,  5.123185301,  4.276837355 },
+        { 2880.0, -8650.73082219, -1914.93811525, -3007.03603443,  3.067165127, -4.828384068, -2.515322836 },
+        { 3240.0, -5429.79204164,  7574.36493792,  3747.39305236, -4.999442110, -1.800561422, -2.229392830 },
+        { 3600.0,  6759.04583722,  2001.58198220,  2783.55192533, -2.180993947,  6.402085603,  3.644723952 },
+        { 3960.0, -3791.44531559, -5712.95617894, -4533.48630714,  6.668817493, -2.516382327, -0.082384354 },
+        { 4320.0, -9060.47373569,  4658.70952502,   813.68673153, -2.232832783, -4.110453490, -3.157345433 } } },
+    { "1 06251U 62025E   06176.82412014  .00008885  00000-0  12808-3 0  3985",
+      "2 06251  58.0579  54.0425 0030035 139.1568 221.1854 15.56387291  6774",
+      10,
+      { {    0.0,  3988.31022699,  5498.96657235,     0.90055879, -3.290032738,  2.357652820,  6.496623475 },
+        {  120.0, -3935.69800083,   409.10980837,  5471.33577327, -3.374784183, -6.635211043, -1.942056221 },
+        {  240.0, -1675.12766915, -5683.30432352, -3286.21510937,  5.282496925,  1.508674259, -5.354872978 },
+        {  360.0,  4993.62642836,  2890.54969900, -3600.40145627,  0.347333429,  5.707031557,  5.070699638 },
+        {  480.0, -1115.07959514,  4015.11691491,  5326.99727718, -5.524279443, -4.765738774,  2.402255961 },
+        {  600.0, -4329.10008198, -5176.70287935,   409.65313857,  2.858408303, -2.933091792, -6.509690397 },
+        {  720.0,  3692.60030028,  -976.24265255, -5623.36447493,  3.897257243,  6.415554948,  1.429112190 },
+        {  960.0, -4990.91637950, -2303.42547880,  3920.86335598, -0.993439372, -5.967458360, -4.759110856 },
+        { 1080.0,   642.27769977, -4332.89821901, -5183.31523910,  5.720542579,  4.216573838, -2.846576139 },
+        { 1200.0,  4719.78335752,  4798.06938996,  -943.58851062, -2.294860662,  3.492499389,  6.408334723 } } },
+};
+#define CASE_COUNT (int)(sizeof(CASES) / sizeof(CASES[0]))
+
+static double distance3(const double a[3], const double b[3]) {
+    return sqrt((a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1]) + (a[2] - b[2]) * (a[2] - b[2]));
+}
+
+int main(void) {
+    Satellite sats[CASE_COUNT];
+    int idx[CASE_COUNT], failures = 0;
+    memset(sats, 0, sizeof(sats));
+    for (int c = 0; c < CASE_COUNT; ++c) {
+        MappedLine lines[3] = { { "CASE", 4 }, { CASES[c].line1, strlen(CASES[c].line1) },
+                                { CASES[c].line2, strlen(CASES[c].line2) } };
+        parse_tle_record(lines, &sats[c]);
+        idx[c] = c;
+        if (!sats[c].valid || !sats[c].sgp4.active) {
+            printf("  %05d: not set up as a near-Earth SGP4 object\n", sats[c].norad_id);
+            failures++;
+            continue;
+        }
+        double worst_km = 0, worst_kms = 0;
+        for (int k = 0; k < CASES[c].count; ++k) {
+            const double *row = CASES[c].rows[k];
+            double r[3], v[3];
+            if (!sgp4_state(&sats[c].sgp4, row[0], r, v)) {
+                printf("  %05d at %.0f min: no solution\n", sats[c].norad_id, row[0]);
+                failures++;
+                continue;
+            }
+            double dr = distance3(r, &row[1]), dv = distance3(v, &row[4]);
+            worst_km = fmax(worst_km, dr);
+            worst_kms = fmax(worst_kms, dv);
+            if (dr > CHECK_POS_KM || dv > CHECK_VEL_KMS) {
+                printf("  %05d at %.0f min: off by %.3e km, %.3e km/s\n", sats[c].norad_id, row[0], dr, dv);
+                failures++;
+            }
+        }
+        fprintf(stderr, "%05d: %d vectors, worst %.3e km, %.3e km/s.\n", sats[c].norad_id, CASES[c].count, worst_km,
+                worst_kms);
+    }
+    if (failures) return 1;
+
+    /* The batch takes one time for every lane, so step from the later epoch. */
+    OrbitBatch batch;
+    if (!orbit_batch_build(&batch, sats, idx, CASE_COUNT, CASE_COUNT, MODEL_SGP4)) return 2;
+    double *out = aligned_alloc(64, sizeof(double) * 6 * batch.padded);
+    if (!out) return 2;
+    double *x = out, *y = x + batch.padded, *z = y + batch.padded;
+    double *vx = z + batch.padded, *vy = vx + batch.padded, *vz = vy + batch.padded;
+    double t0 = fmax(sats[0].epoch_time, sats[1].epoch_time), worst_km = 0, worst_kms = 0;
+    for (double t = t0; t <= t0 + 86400.0; t += 600.0) {
+        propagate_batch(&batch, t, x, y, z, vx, vy, vz);
+        for (int c = 0; c < CASE_COUNT; ++c) {
+            double r[3], v[3];
+            sgp4_state(&sats[c].sgp4, (t - sats[c].epoch_time) / 60.0, r, v);
+            double dr = distance3(r, (double[3]){ x[c], y[c], z[c] });
+            double dv = distance3(v, (double[3]){ vx[c], vy[c], vz[c] });
+            worst_km = fmax(worst_km, dr);
+            worst_kms = fmax(worst_kms, dv);
+            if ((dr > CHECK_BATCH_KM || dv > CHECK_BATCH_KMS) && failures++ < 20) {
+                printf("  %05d batch at %+.0f s: off by %.3e km, %.3e km/s\n", sats[c].norad_id, t - t0, dr, dv);
+            }
+        }
+    }
+    fprintf(stderr, "propagate_batch against sgp4_state: worst %.3e km, %.3e km/s.\n", worst_km, worst_kms);
+    free(out);
+    orbit_batch_free(&batch);
+    return failures > 0;
+}
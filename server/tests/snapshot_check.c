@@ -0,0 +1,106 @@
+/*
+ * Parses a TLE and a SATCAT file, saves the catalog as a snapshot and loads
+ * it back: the loaded catalog must match the parsed one byte for byte.
+ * Then the snapshot must be refused when it is cut short anywhere, when its
+ * header does not match this build, and when a text file is newer than it.
+ * Prints each failure and exits 1 if there is any.
+ *
+ *   snapshot_check <tle file> <satcat file> <snapshot path>
+ */
+#define main server_main
+#include "../server.c"
+#undef main
+
+#include <utime.h>
+
+static int failures;
+
+static void check(int ok, const char *what) {
+    if (!ok) {
+        printf("  %s\n", what);
+        failures++;
+    }
+}
+
+/* Writes the first `size` bytes of `data` to `path`; 0 on failure. */
+static int write_prefix(const char *path, const char *data, size_t size) {
+    FILE *f = fopen(path, "wb");
+    if (!f) return 0;
+    int ok = fwrite(data, 1, size, f) == size;
+    return fclose(f) == 0 && ok;
+}
+
+/* 1 when catalog_snapshot_load refuses what is at `path`. */
+static int refused(const char *path, const char *tle_filename, const char *satcat_filename) {
+    Catalog *catalog = catalog_snapshot_load(path, tle_filename, satcat_filename);
+    if (!catalog) return 1;
+    catalog_release(catalog);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 4) {
+        fprintf(stderr, "usage: %s <tle file> <satcat file> <snapshot path>\n", argv[0]);
+        return 2;
+    }
+    const char *tle_filename = argv[1], *satcat_filename = argv[2], *path = argv[3];
+    worker_pool_start(&SCREEN_POOL, SCREEN_THREADS);
+    Catalog *parsed = catalog_alloc(1);
+    int capacity = 0, satcat_capacity = 0;
+    if (!parsed || (parsed->count = load_tle_file(tle_filename, &parsed->sats, &capacity)) < 0
+        || (parsed->satcat_count = load_satcat_file(satcat_filename, &parsed->satcat, &satcat_capacity)) < 0) {
+        fprintf(stderr, "Could not read '%s' or '%s'.\n", tle_filename, satcat_filename);
+        return 2;
+    }
+    catalog_publish(parsed);
+    if (!catalog_snapshot_save(path)) {
+        fprintf(stderr, "Could not write '%s'.\n", path);
+        return 2;
+    }
+
+    Catalog *loaded = catalog_snapshot_load(path, tle_filename, satcat_filename);
+    check(loaded != NULL, "the snapshot just written was refused");
+    if (loaded) {
+        check(loaded->count == parsed->count && loaded->satcat_count == parsed->satcat_count,
+              "the snapshot holds a different number of records");
+        check(loaded->count != parsed->count
+              || memcmp(loaded->sats, parsed->sats, sizeof(Satellite) * parsed->count) == 0,
+              "the satellites differ from the parsed ones");
+        check(loaded->satcat_count != parsed->satcat_count
+              || memcmp(loaded->satcat, parsed->satcat, sizeof(SatCatData) * parsed->satcat_count) == 0,
+              "the SATCAT records differ from the parsed ones");
+        catalog_release(loaded);
+    }
+
+    MappedFile file;
+    if (!map_file(path, &file)) return 2;
+    char cut_path[512];
+    snprintf(cut_path, sizeof(cut_path), "%s.cut", path);
+    /* Inside the header, inside a satellite, inside the SATCAT records and one byte short. */
+    size_t cuts[] = { 0, sizeof(SnapshotHeader) / 2, sizeof(SnapshotHeader) + sizeof(Satellite) / 2,
+                      file.size - sizeof(SatCatData) / 2, file.size - 1 };
+    for (size_t k = 0; k < sizeof(cuts) / sizeof(cuts[0]); ++k) {
+        char what[96];
+        snprintf(what, sizeof(what), "a snapshot cut to %zu of %zu bytes was accepted", cuts[k], file.size);
+        check(write_prefix(cut_path, file.data, cuts[k]) && refused(cut_path, tle_filename, satcat_filename), what);
+    }
+    char *copy = malloc(file.size);
+    if (!copy) return 2;
+    memcpy(copy, file.data, file.size);
+    ((SnapshotHeader *)copy)->config ^= 1;
+    check(write_prefix(cut_path, copy, file.size) && refused(cut_path, tle_filename, satcat_filename),
+          "a snapshot from a build with another layout was accepted");
+    free(copy);
+    unmap_file(&file);
+    remove(cut_path);
+
+    /* A text file edited after the snapshot was written makes it stale. */
+    struct stat st;
+    if (stat(path, &st) != 0) return 2;
+    struct utimbuf later = { st.st_atime, st.st_mtime + 1 };
+    check(utime(tle_filename, &later) == 0 && refused(path, tle_filename, satcat_filename),
+          "a snapshot older than its TLE file was accepted");
+    fprintf(stderr, "%d satellites, %d SATCAT records, %d failures.\n", parsed->count, parsed->satcat_count,
+            failures);
+    return failures > 0;
+}
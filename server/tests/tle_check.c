@@ -0,0 +1,97 @@
+/*
+ * Loads a TLE file with load_tle_file and again with the loader it
+ * replaced: fgets per line, and fields through strncpy and atof, the
+ * implied-decimal ones built as "0." strings and the epoch's January 1 from
+ * timegm. Every record must come out with the same lines and bit-identical
+ * fields. Prints each mismatch and exits 1 if there is any.
+ *
+ *   tle_check <tle file>
+ */
+#define main server_main
+#include "../server.c"
+#undef main
+
+static double atof_field(const char *line, int start, int len) {
+    char buf[32];
+    strncpy(buf, line + start, len);
+    buf[len] = '\0';
+    return atof(buf);
+}
+
+static int atoi_field(const char *line, int start, int len) {
+    char buf[32];
+    strncpy(buf, line + start, len);
+    buf[len] = '\0';
+    return atoi(buf);
+}
+
+static double atof_fraction(const char *line, int start, int len) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "0.%.*s", len, line + start);
+    return atof(buf);
+}
+
+static void chomp(char *s) {
+    size_t n = strlen(s);
+    while (n > 0 && (s[n - 1] == '\n' || s[n - 1] == '\r')) s[--n] = '\0';
+}
+
+static int mismatches;
+
+static void expect(const Satellite *sat, const char *field, double got, double want) {
+    if (got == want || (isnan(got) && isnan(want))) return;
+    if (mismatches++ < 20) printf("  %d %s: %.17g, the atof path gives %.17g\n", sat->norad_id, field, got, want);
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <tle file>\n", argv[0]);
+        return 2;
+    }
+    worker_pool_start(&SCREEN_POOL, SCREEN_THREADS);
+    Satellite *sats = NULL;
+    int capacity = 0;
+    int count = load_tle_file(argv[1], &sats, &capacity);
+    FILE *f = fopen(argv[1], "r");
+    if (count < 0 || !f) {
+        fprintf(stderr, "Could not read '%s'.\n", argv[1]);
+        return 2;
+    }
+    char name[LINE_LEN], tle1[LINE_LEN], tle2[LINE_LEN];
+    int records = 0;
+    while (fgets(name, LINE_LEN, f)) {
+        chomp(name);
+        if (strlen(name) == 0) continue;
+        if (!fgets(tle1, LINE_LEN, f) || !fgets(tle2, LINE_LEN, f)) break;
+        chomp(tle1);
+        chomp(tle2);
+        if (records >= count) { records++; continue; }
+        const Satellite *sat = &sats[records++];
+        char short_name[NAME_LEN];
+        strncpy(short_name, name, NAME_LEN - 1);
+        short_name[NAME_LEN - 1] = '\0';
+        if (strcmp(sat->name, short_name) != 0 || strcmp(sat->tle1, tle1) != 0 || strcmp(sat->tle2, tle2) != 0) {
+            if (mismatches++ < 20) printf("  record %d: lines differ from the fgets reader\n", records);
+            continue;
+        }
+        expect(sat, "norad id", sat->norad_id, atoi_field(tle1, 2, 5));
+        int year = atoi_field(tle1, 18, 2);
+        struct tm t = { .tm_year = (year < 57 ? 2000 + year : 1900 + year) - 1900, .tm_mday = 1 };
+        expect(sat, "epoch", sat->epoch_time, timegm(&t) + (atof_field(tle1, 20, 12) - 1.0) * 86400.0);
+        double bstar = atof_fraction(tle1, 54, 5) * pow(10.0, atoi_field(tle1, 59, 2));
+        expect(sat, "bstar", parse_bstar(sat->tle1), tle1[53] == '-' ? -bstar : bstar);
+        expect(sat, "inclination", sat->inclination, deg2rad(atof_field(tle2, 8, 8)));
+        expect(sat, "raan", sat->raan, deg2rad(atof_field(tle2, 17, 8)));
+        expect(sat, "eccentricity", sat->eccentricity, atof_fraction(tle2, 26, 7));
+        expect(sat, "argument of perigee", sat->arg_perigee, deg2rad(atof_field(tle2, 34, 8)));
+        expect(sat, "mean anomaly", sat->mean_anomaly, deg2rad(atof_field(tle2, 43, 8)));
+        expect(sat, "mean motion", sat->mean_motion, atof_field(tle2, 52, 11));
+    }
+    fclose(f);
+    if (records != count) {
+        printf("  load_tle_file found %d records, the fgets reader %d\n", count, records);
+        mismatches++;
+    }
+    fprintf(stderr, "%d records, %d mismatches.\n", count, mismatches);
+    return mismatches > 0;
+}